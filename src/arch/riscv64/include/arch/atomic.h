@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: Arch atomic
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __ARCH_ATOMIC__
+#define __ARCH_ATOMIC__
+
+/**
+ * included by base/atomic.h after NX_Atomic defined, inlined at call site
+ * with CONFIG_NX_HAL_INLINE, else called through NX_AtomicOpsInterface.
+ */
+
+NX_INLINE void NX_HalAtomicSet(NX_Atomic *atomic, long value)
+{
+    atomic->value = value;
+}
+
+NX_INLINE long NX_HalAtomicGet(NX_Atomic *atomic)
+{
+    return atomic->value;
+}
+
+NX_INLINE void NX_HalAtomicAdd(NX_Atomic *atomic, long value)
+{
+    /* gcc build-in functions */
+    __sync_fetch_and_add(&atomic->value, value);
+}
+
+NX_INLINE void NX_HalAtomicSub(NX_Atomic *atomic, long value)
+{
+    __sync_fetch_and_sub(&atomic->value, value);
+}
+
+NX_INLINE void NX_HalAtomicInc(NX_Atomic *atomic)
+{
+    __sync_fetch_and_add(&atomic->value, 1);
+}
+
+NX_INLINE void NX_HalAtomicDec(NX_Atomic *atomic)
+{
+    __sync_fetch_and_sub(&atomic->value, 1);
+}
+
+NX_INLINE void NX_HalAtomicSetMask(NX_Atomic *atomic, long mask)
+{
+    __sync_fetch_and_or(&atomic->value, mask);
+}
+
+NX_INLINE void NX_HalAtomicClearMask(NX_Atomic *atomic, long mask)
+{    
+    __sync_fetch_and_and(&atomic->value, ~mask);
+}
+
+NX_INLINE long NX_HalAtomicSwap(NX_Atomic *atomic, long newValue)
+{
+    return __sync_lock_test_and_set(&((atomic)->value), newValue);
+}
+
+NX_INLINE long NX_HalAtomicCAS(NX_Atomic *atomic, long old, long newValue)
+{
+    return __sync_val_compare_and_swap(&atomic->value, old, newValue);
+}
+
+NX_INLINE long NX_HalAtomicFetchAdd(NX_Atomic *atomic, long value)
+{
+    return __sync_fetch_and_add(&atomic->value, value);
+}
+
+#endif /* __ARCH_ATOMIC__ */
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: Arch irq level
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __ARCH_IRQ__
+#define __ARCH_IRQ__
+
+#include <nxos.h>
+#include <regs.h>
+
+/**
+ * inlined at call site with CONFIG_NX_HAL_INLINE, else called through
+ * NX_IRQ_ControllerInterface. memory clobber keeps accesses in irq disabled range.
+ */
+
+NX_INLINE void NX_HalIrqEnable(void)
+{
+    NX_CASM("csrs sstatus, %0" : : "i" (SSTATUS_SIE) : "memory");
+}
+
+NX_INLINE void NX_HalIrqDisable(void)
+{
+    NX_CASM("csrc sstatus, %0" : : "i" (SSTATUS_SIE) : "memory");
+}
+
+/* clear SIE and get old one with single csrrc */
+NX_INLINE NX_UArch NX_HalIrqSaveLevel(void)
+{
+    NX_UArch level;
+    NX_CASM("csrrc %0, sstatus, %1" : "=r" (level) : "i" (SSTATUS_SIE) : "memory");
+    return level & SSTATUS_SIE;
+}
+
+NX_INLINE void NX_HalIrqRestoreLevel(NX_UArch level)
+{
+    NX_CASM("csrs sstatus, %0" : : "r" (level & SSTATUS_SIE) : "memory");
+}
+
+NX_INLINE NX_Bool NX_HalIrqIsEnabled(void)
+{
+    return (ReadCSR(sstatus) & SSTATUS_SIE) ? NX_True : NX_False;
+}
+
+#endif /* __ARCH_IRQ__ */
@@ -60,6 +60,13 @@
 #define NX_PAGE_ATTR_RWX    (PTE_X | PTE_W | PTE_R)
 
 #define NX_PAGE_ATTR_KERNEL (PTE_V | NX_PAGE_ATTR_RWX | PTE_S | PTE_G)
-#define NX_PAGE_ATTR_USER   (PTE_V | NX_PAGE_ATTR_RWX | PTE_U | PTE_G)
+/* user pages not global, tlb entries of them are tagged with asid */
+#define NX_PAGE_ATTR_USER   (PTE_V | NX_PAGE_ATTR_RWX | PTE_U)
+
+#ifdef CONFIG_NX_MMU_ASID
+struct NX_Mmu;
+void NX_HalSwitchPageTable(struct NX_Mmu *mmu);
+NX_UArch NX_HalProbeAsidBits(void);
+#endif
 
 #endif  /* __ARCH_MMU__ */
@@ -0,0 +1,34 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: Arch per cpu data
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __ARCH_PERCPU__
+#define __ARCH_PERCPU__
+
+#include <nxos.h>
+
+/**
+ * tp holds per cpu data of current core in kernel, user tp is saved in trap frame.
+ * trap from user loads tp from the slot on top of the core trap stack.
+ */
+#define NX_HalCpuLocal() ({ \
+    void *__cpu; \
+    NX_CASM("mv %0, tp" : "=r" (__cpu)); \
+    __cpu; \
+})
+
+/* load a word in per cpu data with one instruction, never torn by migration */
+#define NX_HalCpuLocalLoad(offset) ({ \
+    NX_UArch __val; \
+    NX_CASM("ld %0, %1(tp)" : "=r" (__val) : "i" (offset)); \
+    __val; \
+})
+
+#endif /* __ARCH_PERCPU__ */
@@ -14,6 +14,7 @@
 
 #include <nxos.h>
 #include <riscv.h>
+#include <regs.h>
 
 #define CONTEXT_REG_NR  33
 
@@ -28,6 +29,7 @@
  * sscratch was used to save sp for temp register when trap or context switch,
  * sp maybe user sp or kernel sp,
  * only save need sscratch, restore no need it.
+ * tp is per cpu data in kernel, user tp is saved in context.
  */
 /* x1 broken in this func */
 .macro SAVE_CONTEXT
@@ -84,6 +86,12 @@
 
     LOAD x1, CTX_STATUS_OFF * REGBYTES(sp)
     csrw sstatus, x1
+
+    /* return to supervisor keeps tp of current core, context may saved on other core */
+    andi x1, x1, SSTATUS_SPP
+    beqz x1, 1f
+    STORE x4, 4*REGBYTES(sp)
+1:
     
     LOAD x1, 1*REGBYTES(sp)
     LOAD x3, 3*REGBYTES(sp)
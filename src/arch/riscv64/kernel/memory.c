@@ -15,6 +15,7 @@
 #include <page_zone.h>
 #include <base/page.h>
 #include <base/mmu.h>
+#include <base/asid.h>
 #include <base/page.h>
 #include <arch/mmu.h>
 #include <riscv.h>
@@ -108,6 +109,10 @@ void NX_HalPageZoneInit(void)
     NX_MmuSetPageTable((NX_UArch)KernelMMU.table);
     NX_MmuEnable();
 
+#ifdef CONFIG_NX_MMU_ASID
+    NX_AsidInit(NX_HalProbeAsidBits());
+#endif
+
     NX_LOG_I("MMU enabled");
     
     NX_LOG_I("Memroy init done.");
@@ -23,6 +23,7 @@
 
 #include <base/thread.h>
 #include <base/smp.h>
+#include <base/sched.h>
 #include <base/memory.h>
 
  /* (syscall) Environment call from U-mode */
@@ -142,37 +143,15 @@ void TrapFrameDump(NX_HalTrapFrame *frame)
     NX_LOG_RAW("------------ Trap frame Dump Done ------------\n");
 }
 
-NX_IMPORT NX_Addr gTrapEntry0;
-NX_IMPORT NX_Addr gTrapEntry1;
-NX_IMPORT NX_Addr gTrapEntry2;
-NX_IMPORT NX_Addr gTrapEntry3;
-NX_IMPORT NX_Addr gTrapEntry4;
+NX_IMPORT NX_Addr gTrapEntry;
 
+/**
+ * all cores share one trap entry, sscratch tells the trap stack of the core
+ */
 void CPU_InitTrap(NX_UArch coreId)
 {
-    NX_Addr *trapEntry = 0;
-    switch (coreId)
-    {
-    case 0:
-        trapEntry = &gTrapEntry0;
-        break;
-    case 1:
-        trapEntry = &gTrapEntry1;
-        break;
-    case 2:
-        trapEntry = &gTrapEntry2;
-        break;
-    case 3:
-        trapEntry = &gTrapEntry3;
-        break;
-    case 4:
-        trapEntry = &gTrapEntry4;
-        break;
-    default:
-        return;
-    }
     /* set trap entry */
-    WriteCSR(stvec, trapEntry);
+    WriteCSR(stvec, &gTrapEntry);
 
     /* Enable soft interrupt */
     SetCSR(sie, SIE_SSIE);
@@ -215,6 +194,13 @@ void TrapDispatch(NX_HalTrapFrame *frame)
         NX_HalClockHandler();
         return;
     }
+    else if ((SCAUSE_INTERRUPT | SCAUSE_S_SOFTWARE_INTR) == cause)
+    {
+        /* supervisor software interrupt, ipi from other core */
+        ClearCSR(sip, SIP_SSIE);
+        NX_SMP_IpiHandler();
+        return;
+    }
     else if (SCAUSE_INTERRUPT & cause)
     {
         if(id < sizeof(interruptName) / sizeof(const char *))
@@ -235,6 +221,8 @@ void TrapDispatch(NX_HalTrapFrame *frame)
             NX_IRQ_Enable();
             NX_HalProcessSyscallDispatch(frame);
             NX_IRQ_Disable();
+            /* syscall may wakeup higher priority thread, check sched like x86 syscall exit */
+            NX_ReSchedCheck();
             return;
         }
 
@@ -263,7 +251,7 @@ NX_U8 *TrapSwitchStack(NX_HalTrapFrame *frame)
     NX_U8 *sp;
     if ((sstatus & SSTATUS_SPP)) /* trap from supervisor */
     {
-        sp = (NX_U8 *)ReadCSR(sscratch); /* read from sscratch, it saved old sp in kernel */
+        sp = (NX_U8 *)frame->sp; /* old sp in kernel saved in frame */
     }
     else    /* trap from user */
     {
@@ -12,6 +12,8 @@
 #include <base/clock.h>
 #include <base/irq.h>
 #include <base/delay_irq.h>
+#include <base/smp.h>
+#include <base/hrtimer.h>
 
 #include <clock.h>
 #include <regs.h>
@@ -45,11 +47,95 @@ NX_PRIVATE NX_U64 GetTimerCounter()
     return ret;
 }
 
-void NX_HalClockHandler(void)
+/* timer counter of next clock tick and hrtimer event on each core */
+NX_PRIVATE NX_U64 tickEventCounter[NX_MULTI_CORES_NR];
+NX_PRIVATE NX_U64 hrtimerEventCounter[NX_MULTI_CORES_NR];
+
+/**
+ * one comparator on each core, program the earlier event of tick and hrtimer
+ */
+NX_PRIVATE void ClockProgramEvent(NX_UArch coreId)
+{
+    NX_U64 counter = tickEventCounter[coreId];
+
+    if (hrtimerEventCounter[coreId] < counter)
+    {
+        counter = hrtimerEventCounter[coreId];
+    }
+    sbi_set_timer(counter);
+}
+
+NX_INTERFACE NX_U64 NX_HalClockNanosecond(void)
+{
+    NX_U64 counter = GetTimerCounter();
+
+    return counter / NX_TIMER_CLK_FREQ * NX_NANOSECOND_PER_SECOND +
+        counter % NX_TIMER_CLK_FREQ * NX_NANOSECOND_PER_SECOND / NX_TIMER_CLK_FREQ;
+}
+
+NX_INTERFACE void NX_HalClockSetOneshot(NX_U64 nanoseconds)
+{
+    NX_UArch coreId = NX_SMP_GetIdx();
+    NX_U64 counter = NX_HRTIMER_NEVER;
+
+    if (nanoseconds != NX_HRTIMER_NEVER)
+    {
+        /* round up, never fire before expires */
+        counter = nanoseconds / NX_NANOSECOND_PER_SECOND * NX_TIMER_CLK_FREQ +
+            NX_DIV_ROUND_UP(nanoseconds % NX_NANOSECOND_PER_SECOND * NX_TIMER_CLK_FREQ, NX_NANOSECOND_PER_SECOND);
+    }
+    hrtimerEventCounter[coreId] = counter;
+    ClockProgramEvent(coreId);
+}
+
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+/* timer counter of last tick on each core */
+NX_PRIVATE NX_U64 lastTickCounter[NX_MULTI_CORES_NR];
+
+NX_INTERFACE void NX_HalClockSetEvent(NX_ClockTick ticks)
+{
+    NX_UArch coreId = NX_SMP_GetIdx();
+
+    tickEventCounter[coreId] = lastTickCounter[coreId] + ticks * tickDelta;
+    ClockProgramEvent(coreId);
+}
+
+NX_PRIVATE void ClockTickHandler(NX_UArch coreId, NX_U64 counter)
+{
+    NX_U64 ticks;
+
+    /* recalc ticks from timer counter, core may sleep many ticks */
+    ticks = (counter - lastTickCounter[coreId]) / tickDelta;
+    lastTickCounter[coreId] += ticks * tickDelta;
+
+    NX_ClockTickAdvance(ticks);
+    NX_HalClockSetEvent(NX_ClockNextEventTicks());
+}
+#else
+NX_PRIVATE void ClockTickHandler(NX_UArch coreId, NX_U64 counter)
 {
     NX_ClockTickGo();
-    /* update timer */
-    sbi_set_timer(GetTimerCounter() + tickDelta);
+    /* next tick on period boundary, hrtimer interrupt between ticks not shift it */
+    tickEventCounter[coreId] += tickDelta;
+}
+#endif
+
+void NX_HalClockHandler(void)
+{
+    NX_UArch coreId = NX_SMP_GetIdx();
+    NX_U64 counter = GetTimerCounter();
+
+    if (counter >= tickEventCounter[coreId])
+    {
+        ClockTickHandler(coreId, counter);
+    }
+    if (counter >= hrtimerEventCounter[coreId])
+    {
+        /* hrtimer run programs next one */
+        hrtimerEventCounter[coreId] = NX_HRTIMER_NEVER;
+        NX_HrTimerRun();
+    }
+    ClockProgramEvent(coreId);
 }
 
 NX_INTERFACE NX_Error NX_HalInitClock(void)
@@ -58,7 +144,14 @@ NX_INTERFACE NX_Error NX_HalInitClock(void)
     ClearCSR(sie, SIE_STIE);
 
     /* Set timer */
-    sbi_set_timer(GetTimerCounter() + tickDelta);
+    hrtimerEventCounter[NX_SMP_GetIdx()] = NX_HRTIMER_NEVER;
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+    lastTickCounter[NX_SMP_GetIdx()] = GetTimerCounter();
+    NX_HalClockSetEvent(1);
+#else
+    tickEventCounter[NX_SMP_GetIdx()] = GetTimerCounter() + tickDelta;
+    ClockProgramEvent(NX_SMP_GetIdx());
+#endif
 
     /* Enable the Supervisor-Timer bit in SIE */
     SetCSR(sie, SIE_STIE);
@@ -45,29 +45,6 @@ NX_PRIVATE NX_Error NX_HalIrqAck(NX_IRQ_Number irqno)
     return PLIC_Complete(NX_SMP_GetBootCore(), irqno);
 }
 
-NX_PRIVATE void NX_HalIrqEnable(void)
-{
-    WriteCSR(sstatus, ReadCSR(sstatus) | SSTATUS_SIE);
-}
-
-NX_PRIVATE void NX_HalIrqDisable(void)
-{
-    WriteCSR(sstatus, ReadCSR(sstatus) & ~SSTATUS_SIE);
-}
-
-NX_PRIVATE NX_UArch NX_HalIrqSaveLevel(void)
-{
-    NX_UArch level = 0;
-    level = ReadCSR(sstatus);
-    WriteCSR(sstatus, level & ~SSTATUS_SIE);
-    return level & SSTATUS_SIE;
-}
-
-NX_PRIVATE void NX_HalIrqRestoreLevel(NX_UArch level)
-{
-    WriteCSR(sstatus, ReadCSR(sstatus) | (level & SSTATUS_SIE));
-}
-
 NX_INTERFACE NX_IRQ_Controller NX_IRQ_ControllerInterface = 
 {
     .unmask = NX_HalIrqUnmask,
@@ -77,4 +54,5 @@ NX_INTERFACE NX_IRQ_Controller NX_IRQ_ControllerInterface =
     .disable = NX_HalIrqDisable,
     .saveLevel = NX_HalIrqSaveLevel,
     .restoreLevel = NX_HalIrqRestoreLevel,
+    .isEnabled = NX_HalIrqIsEnabled,
 };
@@ -11,6 +11,7 @@
  */
 
 #include <base/mmu.h>
+#include <base/asid.h>
 #include <arch/mmu.h>
 #include <base/page.h>
 #include <regs.h>
@@ -18,6 +19,9 @@
 #include <base/debug.h>
 #include <base/irq.h>
 #include <base/memory.h>
+#include <base/smp.h>
+#include <base/barrier.h>
+#include <platform.h>
 
 #define NX_LOG_LEVEL NX_LOG_INFO
 #define NX_LOG_NAME "MMU"
@@ -46,11 +50,38 @@
 #define MAKE_SATP_MODE (MMU_MODE_SV39 << MMU_MODE_BIT_SHIFT)
 #define GET_ADDR_FROM_SATP(satp) ((((NX_Addr)satp) << NX_PAGE_SHIFT))
 
+#define SATP_ASID_SHIFT 44
+#define SATP_ASID_MASK  (0xffffUL << SATP_ASID_SHIFT)
+#define MAKE_SATP_ASID(asid) ((((NX_Addr)(asid)) << SATP_ASID_SHIFT) & SATP_ASID_MASK)
+
+/* flush whole space instead of page by page when unmap more pages */
+#define MMU_FLUSH_PAGES_MAX 32
+
+/* leaf pages unmapped in one batch, freed after tlb of all cores flushed */
+#define MMU_UNMAP_BATCH 64
+
 NX_INLINE void SFenceVMA()
 {
     NX_CASM("sfence.vma");
 }
 
+/* flush entries of `addr` in all address spaces, include global ones */
+NX_INLINE void SFenceVMAAddr(NX_Addr addr)
+{
+    NX_CASM("sfence.vma %0" : : "r" (addr) : "memory");
+}
+
+/* flush none-global entries tagged with `asid` */
+NX_INLINE void SFenceVMAAsid(NX_UArch asid)
+{
+    NX_CASM("sfence.vma zero, %0" : : "r" (asid) : "memory");
+}
+
+NX_INLINE void SFenceVMAAddrAsid(NX_Addr addr, NX_UArch asid)
+{
+    NX_CASM("sfence.vma %0, %1" : : "r" (addr), "r" (asid) : "memory");
+}
+
 #define MMU_FlushTLB() SFenceVMA()
 
 typedef NX_U64 MMU_PDE; /* page dir entry */
@@ -167,7 +198,10 @@ NX_PRIVATE NX_Error MapOnePage(NX_Mmu *mmu, NX_Addr virAddr, NX_Addr phyAddr, NX
     return NX_EOK;
 }
 
-NX_PRIVATE NX_Error UnmapOnePage(NX_Mmu *mmu, NX_Addr virAddr)
+/**
+ * clear pte of `virAddr`, return the leaf page, caller frees it after tlb flushed
+ */
+NX_PRIVATE NX_Addr UnmapOnePage(NX_Mmu *mmu, NX_Addr virAddr)
 {
     MMU_PDE *pageTable = (MMU_PDE *)mmu->table;
     MMU_PTE *pte;
@@ -183,7 +217,6 @@ NX_PRIVATE NX_Error UnmapOnePage(NX_Mmu *mmu, NX_Addr virAddr)
     NX_ASSERT(PAGE_IS_LEAF(*pte));
     phyPage = PTE2PADDR(*pte);
     NX_ASSERT(phyPage);
-    NX_PageFree((void *)phyPage);   /* free leaf page*/
     *pte = 0; /* clear pte in level 0 */
     
     /* free none-leaf page */
@@ -206,14 +239,17 @@ NX_PRIVATE NX_Error UnmapOnePage(NX_Mmu *mmu, NX_Addr virAddr)
             *pte = 0;   /* clear pte in level 2 */
         }
     }
-    return NX_EOK;
+    return phyPage;
 }
 
+/**
+ * undo pages just mapped when map failed, not used by any core yet
+ */
 NX_INLINE NX_Error __UnmapPage(NX_Mmu *mmu, NX_Addr virAddr, NX_Size pages)
 {
     while (pages > 0)
     {
-        UnmapOnePage(mmu, virAddr);
+        NX_PageFree((void *)UnmapOnePage(mmu, virAddr));
         virAddr += NX_PAGE_SIZE;
         pages--;
     }
@@ -317,6 +353,96 @@ NX_PRIVATE void *NX_HalMapPageWithPhy(NX_Mmu *mmu, NX_Addr virAddr, NX_Addr phyA
     return addr;
 }
 
+typedef struct MMU_FlushRange
+{
+    NX_UArch asid;
+    NX_Addr virAddr;
+    NX_Size pages;
+} MMU_FlushRange;
+
+/**
+ * flush tlb entries of range on current core, called irq disabled
+ */
+NX_PRIVATE void MMU_FlushLocal(void *arg)
+{
+    MMU_FlushRange *range = (MMU_FlushRange *)arg;
+    NX_UArch asid = range->asid;
+    NX_Addr virAddr = range->virAddr;
+    NX_Size pages = range->pages;
+
+    if (pages > MMU_FLUSH_PAGES_MAX)
+    {
+        if (asid == NX_ASID_KERNEL)
+        {
+            MMU_FlushTLB();
+        }
+        else
+        {
+            SFenceVMAAsid(asid);
+        }
+    }
+    else
+    {
+        while (pages > 0)
+        {
+            if (asid == NX_ASID_KERNEL)
+            {
+                SFenceVMAAddr(virAddr);
+            }
+            else
+            {
+                SFenceVMAAddrAsid(virAddr, asid);
+            }
+            virAddr += NX_PAGE_SIZE;
+            pages--;
+        }
+    }
+}
+
+/**
+ * flush tlb entries of pages unmapped on current core and on cores loaded the page table,
+ * other cores may cache them with asid, they flush when switch to the space next time.
+ * the unmapped pages can be freed after it returned. called irq disabled.
+ */
+NX_PRIVATE void MMU_FlushUnmapped(NX_Mmu *mmu, NX_Addr virAddr, NX_Size pages)
+{
+    NX_Bool isKernel = (mmu->table == NX_HalGetKernelPageTable()) ? NX_True : NX_False;
+    MMU_FlushRange range;
+    NX_CpuMask cores;
+
+    range.asid = NX_ASID_KERNEL;
+    range.virAddr = virAddr;
+    range.pages = pages;
+
+#ifdef CONFIG_NX_MMU_ASID
+    if (isKernel == NX_False && NX_AsidBits())
+    {
+        range.asid = NX_AsidGet(mmu);
+        if (range.asid == NX_ASID_KERNEL)
+        {
+            return; /* never switched to, no core caches it */
+        }
+    }
+#endif
+
+    MMU_FlushLocal(&range);
+
+#ifdef CONFIG_NX_MMU_ASID
+    if (NX_AsidBits())
+    {
+        NX_AsidMarkStale(isKernel == NX_True ? NX_NULL : mmu);
+    }
+#endif
+
+    /* pte cleared before loaded cores read, pair with page table set before loaded */
+    NX_MemoryBarrier();
+    cores = NX_SMP_TableLoadedCores(isKernel == NX_True ? NX_NULL : mmu->table);
+    if (cores != NX_CPUMASK_NONE)
+    {
+        NX_SMP_CallCores(cores, MMU_FlushLocal, &range);
+    }
+}
+
 NX_PRIVATE NX_Error NX_HalUnmapPage(NX_Mmu *mmu, NX_Addr virAddr, NX_Size size)
 {
     NX_ASSERT(mmu);
@@ -327,11 +453,31 @@ NX_PRIVATE NX_Error NX_HalUnmapPage(NX_Mmu *mmu, NX_Addr virAddr, NX_Size size)
     NX_Addr addrStart = virAddr;
     NX_Addr addrEnd = virAddr + size - 1;
     NX_Size pages = GET_PF_ID(addrEnd) - GET_PF_ID(addrStart) + 1;
+    NX_Addr phyPages[MMU_UNMAP_BATCH];
+    NX_Size count;
+    NX_Size i;
 
     NX_UArch level = NX_IRQ_SaveLevel();
-    NX_Error err = __UnmapPage(mmu, virAddr, pages);
+    while (pages > 0)
+    {
+        count = pages > MMU_UNMAP_BATCH ? MMU_UNMAP_BATCH : pages;
+        for (i = 0; i < count; i++)
+        {
+            phyPages[i] = UnmapOnePage(mmu, virAddr + i * NX_PAGE_SIZE);
+        }
+
+        /* no core reaches the pages by tlb when freed */
+        MMU_FlushUnmapped(mmu, virAddr, count);
+        for (i = 0; i < count; i++)
+        {
+            NX_PageFree((void *)phyPages[i]);
+        }
+
+        virAddr += count * NX_PAGE_SIZE;
+        pages -= count;
+    }
     NX_IRQ_RestoreLevel(level);
-    return err;
+    return NX_EOK;
 }
 
 NX_PRIVATE void *NX_HalVir2Phy(NX_Mmu *mmu, NX_Addr virAddr)
@@ -368,6 +514,58 @@ NX_PRIVATE void NX_HalSetPageTable(NX_Addr addr)
     MMU_FlushTLB();
 }
 
+#ifdef CONFIG_NX_MMU_ASID
+/**
+ * switch to page table of `mmu` (NX_NULL for kernel) tagged with its asid,
+ * tlb flushed only when the asid reused or has stale entries on this core.
+ * called irq disabled.
+ */
+void NX_HalSwitchPageTable(NX_Mmu *mmu)
+{
+    int flush;
+    NX_UArch asid = NX_AsidSwitch(mmu, &flush);
+    void *table = (mmu != NX_NULL) ? mmu->table : NX_HalGetKernelPageTable();
+    NX_Addr satp = ReadCSR(satp);
+    NX_Addr newSatp = (satp & MMU_MODE_MASK) | MAKE_SATP_ASID(asid) | MAKE_SATP_ADDR(NX_Virt2Phy(table));
+
+    if (newSatp != satp)
+    {
+        WriteCSR(satp, newSatp);
+    }
+
+    if (flush == NX_ASID_FLUSH_ALL)
+    {
+        MMU_FlushTLB();
+    }
+    else if (flush == NX_ASID_FLUSH_ASID)
+    {
+        SFenceVMAAsid(asid);
+    }
+}
+
+/**
+ * asid bits implemented, write all ones to satp asid field and read back
+ */
+NX_UArch NX_HalProbeAsidBits(void)
+{
+    NX_Addr satp = ReadCSR(satp);
+    NX_Addr asidMask;
+    NX_UArch bits = 0;
+
+    WriteCSR(satp, satp | SATP_ASID_MASK);
+    asidMask = (ReadCSR(satp) & SATP_ASID_MASK) >> SATP_ASID_SHIFT;
+    WriteCSR(satp, satp);
+    MMU_FlushTLB();
+
+    while (asidMask & 1)
+    {
+        bits++;
+        asidMask >>= 1;
+    }
+    return bits;
+}
+#endif /* CONFIG_NX_MMU_ASID */
+
 NX_PRIVATE NX_Addr NX_HalGetPageTable(void)
 {
     NX_Addr addr = ReadCSR(satp);
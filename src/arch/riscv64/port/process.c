@@ -20,19 +20,20 @@
 #include <base/debug.h>
 #include <platform.h>
 #include <base/mmu.h>
+#include <base/asid.h>
 #include <base/thread.h>
 #include <interrupt.h>
 #include <regs.h>
 
-NX_PRIVATE void NX_HalProcessSetTls(void *tls);
-
 NX_PRIVATE NX_Error NX_HalProcessInitUserSpace(NX_Process *process, NX_Addr virStart, NX_Size size)
 {
-    void *table = NX_MemAlloc(NX_PAGE_SIZE);
+    /* page table allocated from page for reference count, core loaded it holds one */
+    void *table = NX_PageAlloc(1);
     if (table == NX_NULL)
     {
         return NX_ENOMEM;
     }
+    table = NX_Phy2Virt(table);
     NX_MemZero(table, NX_PAGE_SIZE);
     NX_MemCopy(table, NX_HalGetKernelPageTable(), NX_PAGE_SIZE);
     NX_MmuInit(&process->vmspace.mmu, table, virStart, size, 0);
@@ -46,12 +47,20 @@ NX_PRIVATE NX_Error NX_HalProcessFreePageTable(NX_Vmspace *vmspace)
     {
         return NX_EFAULT;
     }
-    NX_MemFree(vmspace->mmu.table);
+    NX_PageFree(NX_Virt2Phy(vmspace->mmu.table));
     return NX_EOK;
 }
 
-NX_PRIVATE NX_Error NX_HalProcessSwitchPageTable(void *pageTableVir)
+NX_PRIVATE NX_Error NX_HalProcessSwitchPageTable(NX_Vmspace *vmspace)
 {
+#ifdef CONFIG_NX_MMU_ASID
+    if (NX_AsidBits())
+    {
+        NX_HalSwitchPageTable(vmspace != NX_NULL ? &vmspace->mmu : NX_NULL);
+        return NX_EOK;
+    }
+#endif
+    void *pageTableVir = vmspace != NX_NULL ? vmspace->mmu.table : NX_HalGetKernelPageTable();
     NX_Addr pageTablePhy = (NX_Addr)NX_Virt2Phy(pageTableVir);
     /* no need switch same page table */
     if (pageTablePhy != NX_MmuGetPageTable())
@@ -76,18 +85,15 @@ void NX_HalProcessSyscallDispatch(NX_HalTrapFrame *frame)
     NX_LOG_D("riscv64 syscall return: %x", frame->a0);
 }
 
-NX_IMPORT void NX_HalProcessEnterUserMode(void *args, const void *text, void *userStack, void * returnAddr);
+NX_IMPORT void NX_HalProcessEnterUserMode(void *args, const void *text, void *userStack, void * returnAddr, void *tls);
 NX_PRIVATE void NX_HalProcessExecuteUser(const void *text, void *userStack, void *kernelStack, void *args)
 {
     NX_Thread * self;
 
     self = NX_ThreadSelf();
 
-    /* update tls before enter user */
-    NX_HalProcessSetTls(self->resource.tls);
-
     NX_LOG_D("riscv64 process enter user: %p, user stack %p", text, userStack);
-    NX_HalProcessEnterUserMode(args, text, userStack, NX_NULL);
+    NX_HalProcessEnterUserMode(args, text, userStack, NX_NULL, self->resource.tls);
     NX_PANIC("should never return after into user");
 }
 
@@ -103,9 +109,6 @@ NX_PRIVATE void NX_HalProcessExecuteUserThread(const void *text, void *userStack
 
     self = NX_ThreadSelf();
 
-    /* update tls before enter user */
-    NX_HalProcessSetTls(self->resource.tls);
-
     /* copy return code */
     retCodeSz = (NX_Size)__UserThreadReturnCodeEnd - (NX_Size)__UserThreadReturnCodeBegin;
     retCode = userStack - retCodeSz;
@@ -114,7 +117,7 @@ NX_PRIVATE void NX_HalProcessExecuteUserThread(const void *text, void *userStack
     retStack = (NX_Addr *)NX_ALIGN_DOWN((NX_Addr)retCode, sizeof(NX_Addr));
 
     NX_LOG_D("riscv64 process enter user thread: %p, user stack %p", text, retStack);
-    NX_HalProcessEnterUserMode(arg, text, retStack, retCode);
+    NX_HalProcessEnterUserMode(arg, text, retStack, retCode, self->resource.tls);
     NX_PANIC("should never return after into user");
 }
 
@@ -123,14 +126,17 @@ NX_PRIVATE void *NX_HalProcessGetKernelPageTable(void)
     return NX_HalGetKernelPageTable();
 }
 
+/**
+ * tp is per cpu data in kernel, user tls is set when enter user,
+ * and restored from trap frame when return to user.
+ */
 NX_PRIVATE void NX_HalProcessSetTls(void *tls)
 {
-    WriteReg(tp, (NX_Addr)tls);
 }
 
 NX_PRIVATE void * NX_HalProcessGetTls(void)
 {
-    return (void *)ReadReg(tp);
+    return NX_ThreadSelf()->resource.tls;
 }
 
 NX_INTERFACE struct NX_ProcessOps NX_ProcessOpsInterface = 
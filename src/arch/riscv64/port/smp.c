@@ -23,41 +23,16 @@
 #include <regs.h>
 #include <base/mmu.h>
 
-NX_IMPORT NX_Addr gTrapEntry0;
-NX_IMPORT NX_Addr gTrapEntry1;
-NX_IMPORT NX_Addr gTrapEntry2;
-NX_IMPORT NX_Addr gTrapEntry3;
-NX_IMPORT NX_Addr gTrapEntry4;
-
 /**
- * Within SBI, we can't read mhartid, so I try to use `trap entry` to see who am I.
+ * tp holds per cpu data in kernel. sscratch points to the slot on top of the core
+ * trap stack, trap from user loads tp from the slot.
  */
-NX_PRIVATE NX_UArch NX_HalCoreGetIndex(void)
+NX_PRIVATE void NX_HalCoreSetCpuLocal(void *cpu)
 {
-    NX_Addr trapEntry = ReadCSR(stvec);
+    NX_Addr *slot = (NX_Addr *)ReadCSR(sscratch);
 
-    if (trapEntry == (NX_Addr)&gTrapEntry0)
-    {
-        return 0;
-    }
-    else if (trapEntry == (NX_Addr)&gTrapEntry1)
-    {
-        return 1;
-    }
-    else if (trapEntry == (NX_Addr)&gTrapEntry2)
-    {
-        return 2;
-    }
-    else if (trapEntry == (NX_Addr)&gTrapEntry3)
-    {
-        return 3;
-    }
-    else if (trapEntry == (NX_Addr)&gTrapEntry4)
-    {
-        return 4;
-    }
-    /* should never be here */
-    while (1);
+    *slot = (NX_Addr)cpu;
+    WriteReg(tp, cpu);
 }
 
 NX_PRIVATE NX_Error NX_HalCoreBootApp(NX_UArch bootCoreId)
@@ -104,9 +79,38 @@ NX_PRIVATE NX_Error NX_HalCoreEnterApp(NX_UArch appCoreId)
     return NX_EOK;
 }
 
+NX_PRIVATE NX_Error NX_HalCoreSendIpi(NX_UArch coreId)
+{
+    NX_UArch mask = 1UL << coreId;
+    sbi_send_ipi(&mask);
+    return NX_EOK;
+}
+
+/**
+ * wfi will wakeup when interrupt pending even if interrupt disabled,
+ * then enable interrupt to handle it.
+ */
+NX_PRIVATE void NX_HalCoreHalt(void)
+{
+    NX_CASM("wfi");
+    SetCSR(sstatus, SSTATUS_SIE);
+    ClearCSR(sstatus, SSTATUS_SIE);
+}
+
+/**
+ * pause hint from Zihintpause, a nop fence on cores without it.
+ */
+NX_PRIVATE void NX_HalCoreRelax(void)
+{
+    NX_CASM(".word 0x0100000f" : : : "memory");
+}
+
 NX_INTERFACE struct NX_SMP_Ops NX_SMP_OpsInterface = 
 {
-    .getIdx = NX_HalCoreGetIndex,
+    .setCpuLocal = NX_HalCoreSetCpuLocal,
     .bootApp = NX_HalCoreBootApp,
     .enterApp = NX_HalCoreEnterApp,
+    .sendIpi = NX_HalCoreSendIpi,
+    .halt = NX_HalCoreHalt,
+    .cpuRelax = NX_HalCoreRelax,
 };
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: Arch atomic
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __ARCH_ATOMIC__
+#define __ARCH_ATOMIC__
+
+/**
+ * included by base/atomic.h after NX_Atomic defined, inlined at call site
+ * with CONFIG_NX_HAL_INLINE, else called through NX_AtomicOpsInterface.
+ */
+
+#define LOCK_PREFIX "lock "
+
+NX_INLINE void NX_HalAtomicSet(NX_Atomic *atomic, long value)
+{
+    atomic->value = value;
+}
+
+NX_INLINE long NX_HalAtomicGet(NX_Atomic *atomic)
+{
+    return atomic->value;
+}
+
+NX_INLINE void NX_HalAtomicAdd(NX_Atomic *atomic, long value)
+{
+    NX_CASM(LOCK_PREFIX "addl %1,%0"   
+         : "+m" (atomic->value)   
+         : "ir" (value));
+}
+
+NX_INLINE void NX_HalAtomicSub(NX_Atomic *atomic, long value)
+{
+    NX_CASM(LOCK_PREFIX "subl %1,%0"   
+         : "+m" (atomic->value)   
+         : "ir" (value));
+}
+
+NX_INLINE void NX_HalAtomicInc(NX_Atomic *atomic)
+{
+    NX_CASM(LOCK_PREFIX "incl %0"   
+         : "+m" (atomic->value));
+}
+
+NX_INLINE void NX_HalAtomicDec(NX_Atomic *atomic)
+{
+    NX_CASM(LOCK_PREFIX "decl %0"   
+         : "+m" (atomic->value));   
+}
+
+NX_INLINE void NX_HalAtomicSetMask(NX_Atomic *atomic, long mask)
+{
+    NX_CASM(LOCK_PREFIX "orl %0,%1"
+        : : "r" (mask), "m" (*(&atomic->value)) : "memory");
+}
+
+NX_INLINE void NX_HalAtomicClearMask(NX_Atomic *atomic, long mask)
+{    
+    NX_CASM(LOCK_PREFIX "andl %0,%1"
+         : : "r" (~(mask)), "m" (*(&atomic->value)) : "memory");
+}
+
+NX_INLINE long NX_HalAtomicSwap(NX_Atomic *atomic, long newValue)
+{
+    NX_CASM("xchgl %k0,%1"   
+         : "=r" (newValue)
+         : "m" (*(&atomic->value)), "0" (newValue)   
+         : "memory");
+    return newValue;
+}
+
+NX_INLINE long NX_HalAtomicCAS(NX_Atomic *atomic, long old, long newValue)
+{
+    long prev;
+    NX_CASM(LOCK_PREFIX "cmpxchgl %k1,%2"   
+         : "=a"(prev)
+         : "r"(newValue), "m"(*(&atomic->value)), "0"(old)   
+         : "memory");
+    return prev;
+}
+
+NX_INLINE long NX_HalAtomicFetchAdd(NX_Atomic *atomic, long value)
+{
+    NX_CASM(LOCK_PREFIX "xaddl %0,%1"
+         : "+r" (value), "+m" (atomic->value)
+         :
+         : "memory");
+    return value;
+}
+
+#endif /* __ARCH_ATOMIC__ */
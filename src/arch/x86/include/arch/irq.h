@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: Arch irq level
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __ARCH_IRQ__
+#define __ARCH_IRQ__
+
+#include <nxos.h>
+#include <regs.h>
+
+/**
+ * inlined at call site with CONFIG_NX_HAL_INLINE, else called through
+ * NX_IRQ_ControllerInterface. memory clobber keeps accesses in irq disabled range.
+ */
+
+NX_INLINE void NX_HalIrqEnable(void)
+{
+    NX_CASM("sti" : : : "memory");
+}
+
+NX_INLINE void NX_HalIrqDisable(void)
+{
+    NX_CASM("cli" : : : "memory");
+}
+
+NX_INLINE NX_UArch NX_HalIrqSaveLevel(void)
+{
+    NX_UArch level = 0;
+    NX_CASM("pushfl; popl %0; cli":"=g" (level): :"memory");
+    return level;
+}
+
+NX_INLINE void NX_HalIrqRestoreLevel(NX_UArch level)
+{
+    NX_CASM("pushl %0; popfl": :"g" (level):"memory", "cc");
+}
+
+NX_INLINE NX_Bool NX_HalIrqIsEnabled(void)
+{
+    NX_UArch eflags;
+    NX_CASM("pushfl; popl %0":"=g" (eflags): :"memory");
+    return (eflags & EFLAGS_IF) ? NX_True : NX_False;
+}
+
+#endif /* __ARCH_IRQ__ */
@@ -0,0 +1,30 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: Arch per cpu data
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __ARCH_PERCPU__
+#define __ARCH_PERCPU__
+
+#include <nxos.h>
+
+/* load a word in per cpu data with one instruction, never torn by migration */
+#define NX_HalCpuLocalLoad(offset) ({ \
+    NX_UArch __val; \
+    NX_CASM("movl %%fs:%c1, %0" : "=r" (__val) : "i" (offset)); \
+    __val; \
+})
+
+/**
+ * fs segment base is per cpu data of current core in kernel,
+ * the data keeps pointer to itself at first.
+ */
+#define NX_HalCpuLocal() ((void *)NX_HalCpuLocalLoad(0))
+
+#endif /* __ARCH_PERCPU__ */
@@ -48,6 +48,7 @@
 #define INDEX_USER_CODE 4
 #define INDEX_USER_DATA 5
 #define INDEX_USER_TLS 6
+#define INDEX_KERNEL_CPU 7
 
 #define KERNEL_CODE_SEL ((INDEX_KERNEL_CODE << 3) + (SA_TIG << 2) + SA_RPL0)
 #define KERNEL_DATA_SEL ((INDEX_KERNEL_DATA << 3) + (SA_TIG << 2) + SA_RPL0)
@@ -61,6 +62,8 @@
 
 #define USER_TLS_SEL ((INDEX_USER_TLS << 3) + (SA_TIG << 2) + SA_RPL3)
 
+#define KERNEL_CPU_SEL ((INDEX_KERNEL_CPU << 3) + (SA_TIG << 2) + SA_RPL0)
+
 #define GDT_LIMIT           0x000007ff
 #define GDT_PADDR           0x003F0000
 
@@ -77,11 +80,13 @@
 #define GDT_USER_DATA_ATTR          (DA_DRW | DA_DPL3 | DA_32 | DA_G)
 #define GDT_TSS_ATTR                (DA_386TSS)
 #define GDT_USER_TLS_ATTR           (DA_DR | DA_DPL3 | DA_32 | DA_G)  /* read only data seg */
+#define GDT_KERNEL_CPU_ATTR         (DA_DRW | DA_DPL0 | DA_32 | DA_G) /* per cpu data seg */
 
 #ifndef __ASSEMBLY__
 void CPU_InitSegment(void);
 void CPU_TlsSet(NX_Addr base);
 NX_Addr CPU_TlsGet(void);
+void CPU_CpuLocalSet(NX_Addr base);
 #endif
 
 #endif  /*__I386_SEGMENT__*/
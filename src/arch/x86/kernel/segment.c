@@ -43,6 +43,25 @@ void CPU_TlsSet(NX_Addr base)
     seg->baseHigh    = (base >> 24) & 0xff;
 }
 
+NX_PRIVATE NX_Addr cpuLocalBase = 0;
+NX_PRIVATE NX_Bool segmentInited = NX_False;
+
+/**
+ * in kernel, fs segment base is per cpu data of the core.
+ * base bound before segment init is loaded when segment init.
+ */
+void CPU_CpuLocalSet(NX_Addr base)
+{
+    cpuLocalBase = base;
+    if (segmentInited == NX_True)
+    {
+        SetSegment(GDT_OFF2PTR(((struct CPU_Segment *) GDT_VADDR), INDEX_KERNEL_CPU),
+            GDT_BOUND_TOP, base, GDT_KERNEL_CPU_ATTR);
+        /* reload fs to refresh segment cache */
+        NX_CASM("movw %w0, %%fs" : : "r" (KERNEL_CPU_SEL) : "memory");
+    }
+}
+
 NX_Addr CPU_TlsGet(void)
 {
     struct CPU_Segment * seg = GDT_OFF2PTR(((struct CPU_Segment *) GDT_VADDR), INDEX_USER_TLS);
@@ -71,5 +90,9 @@ void CPU_InitSegment(void)
 
     SetSegment(GDT_OFF2PTR(gdt, INDEX_USER_TLS), GDT_BOUND_TOP, GDT_BOUND_BOTTOM, GDT_USER_TLS_ATTR);
 
+    SetSegment(GDT_OFF2PTR(gdt, INDEX_KERNEL_CPU), GDT_BOUND_TOP, cpuLocalBase, GDT_KERNEL_CPU_ATTR);
+
+    /* fs loaded with per cpu segment */
     CPU_LoadGDT(GDT_LIMIT, GDT_VADDR);
+    segmentInited = NX_True;
 }
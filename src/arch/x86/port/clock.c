@@ -14,6 +14,7 @@
 #include <base/clock.h>
 #include <base/irq.h>
 #include <base/delay_irq.h>
+#include <base/hrtimer.h>
 
 #define NX_LOG_NAME "Clock"
 #include <base/log.h>
@@ -132,20 +133,163 @@ enum ctrl_mode_bits
 };
 
 #define TIMER_FREQ     1193180  /* clock frequency */
-#define COUNTER0_VALUE  (TIMER_FREQ / NX_TICKS_PER_SECOND)
+
+#define NANOSECOND_PER_TICK (NX_NANOSECOND_PER_SECOND / NX_TICKS_PER_SECOND)
+
+/* 1000000000 / TIMER_FREQ is 838.0965 ns per count, no 64 bit division here */
+#define NANOSECOND_PER_COUNT    838U
+#define COUNT_FRACTION          965U    /* fraction of ns per count, in 1/10000 ns */
+#define COUNT_FRACTION_SCALE    10000U
+
+/*
+Port 61h, System Control Port B, bit 0 gates counter 2, bit 1 enables speaker output
+*/
+#define PIT_SYSTEM_CTRL     0x61
+#define PIT_COUNTER2_GATE   0x01
+#define PIT_SPEAKER_DATA    0x02
+
+/**
+ * counter 2 wraps every 65536 counts, one shot on counter 0 limited to half of it,
+ * so the clock source is read before it wraps again.
+ */
+#define COUNTER0_MAX_COUNT  0x8000
+
+/**
+ * counter 2 free runs as clock source, counter 0 interrupts once
+ * on the earlier event of next tick and hrtimer.
+ */
+NX_PRIVATE NX_U16 lastCount = 0;
+NX_PRIVATE NX_U32 countFraction = 0;
+NX_PRIVATE NX_U64 clockNanosecond = 0;
+
+NX_PRIVATE NX_U64 tickEvent = 0;
+NX_PRIVATE NX_U64 hrtimerEvent = NX_HRTIMER_NEVER;
+
+NX_INTERFACE NX_U64 NX_HalClockNanosecond(void)
+{
+    NX_UArch level = NX_IRQ_SaveLevel();
+    NX_U16 count;
+    NX_U32 delta;
+    NX_U64 ns;
+
+    /* latch counter 2 and read it */
+    IO_Out8(PIT_CTRL, PIT_MODE_COUNTER_2 | PIT_MODE_LPCV);
+    count = IO_In8(PIT_COUNTER2);
+    count |= IO_In8(PIT_COUNTER2) << 8;
+
+    /* counts down and wraps, counts passed since last read */
+    delta = (NX_U16)(lastCount - count);
+    lastCount = count;
+
+    countFraction += delta * COUNT_FRACTION;
+    clockNanosecond += delta * NANOSECOND_PER_COUNT + countFraction / COUNT_FRACTION_SCALE;
+    countFraction %= COUNT_FRACTION_SCALE;
+    ns = clockNanosecond;
+
+    NX_IRQ_RestoreLevel(level);
+    return ns;
+}
+
+/**
+ * program counter 0 one shot to the earlier event, called irq disabled
+ */
+NX_PRIVATE void ClockProgramEvent(void)
+{
+    NX_U64 event = tickEvent < hrtimerEvent ? tickEvent : hrtimerEvent;
+    NX_U64 now = NX_HalClockNanosecond();
+    NX_U32 count = COUNTER0_MAX_COUNT;
+
+    if (event <= now)
+    {
+        count = 1;
+    }
+    else if (event - now < (NX_U64)COUNTER0_MAX_COUNT * NANOSECOND_PER_COUNT)
+    {
+        /* round up, never fire before event */
+        count = NX_DIV_ROUND_UP((NX_U32)(event - now), NANOSECOND_PER_COUNT);
+    }
+
+    /* mode 0 interrupts on terminal count, writing count restarts countdown */
+    IO_Out8(PIT_CTRL, PIT_MODE_0 | PIT_MODE_MSB_LSB |
+            PIT_MODE_COUNTER_0 | PIT_MODE_BINARY);
+    IO_Out8(PIT_COUNTER0, (NX_U8) (count & 0xff));
+    IO_Out8(PIT_COUNTER0, (NX_U8) (count >> 8) & 0xff);
+}
+
+NX_INTERFACE void NX_HalClockSetOneshot(NX_U64 nanoseconds)
+{
+    hrtimerEvent = nanoseconds;
+    ClockProgramEvent();
+}
+
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+/* nanoseconds of last tick */
+NX_PRIVATE NX_U64 lastTick = 0;
+
+NX_INTERFACE void NX_HalClockSetEvent(NX_ClockTick ticks)
+{
+    tickEvent = lastTick + (NX_U64)ticks * NANOSECOND_PER_TICK;
+    ClockProgramEvent();
+}
+
+NX_PRIVATE void ClockTickHandler(NX_U64 now)
+{
+    NX_ClockTick ticks = 0;
+
+    /* core may sleep many ticks, count them without 64 bit division */
+    while (now - lastTick >= NANOSECOND_PER_TICK)
+    {
+        lastTick += NANOSECOND_PER_TICK;
+        ticks++;
+    }
+
+    NX_ClockTickAdvance(ticks);
+    NX_HalClockSetEvent(NX_ClockNextEventTicks());
+}
+#else
+NX_PRIVATE void ClockTickHandler(NX_U64 now)
+{
+    NX_ClockTick ticks = 0;
+
+    /* next tick on period boundary, hrtimer interrupt between ticks not shift it */
+    while (now >= tickEvent)
+    {
+        tickEvent += NANOSECOND_PER_TICK;
+        ticks++;
+    }
+
+    NX_ClockTickAdvance(ticks);
+}
+#endif
 
 NX_PRIVATE NX_Error ClockHandler(NX_U32 irq, void *arg)
 {
-    NX_ClockTickGo();
+    NX_U64 now = NX_HalClockNanosecond();
+
+    if (now >= tickEvent)
+    {
+        ClockTickHandler(now);
+    }
+    if (now >= hrtimerEvent)
+    {
+        /* hrtimer run programs next one */
+        hrtimerEvent = NX_HRTIMER_NEVER;
+        NX_HrTimerRun();
+    }
+    ClockProgramEvent();
     return NX_EOK;
 }
 
 NX_INTERFACE NX_Error NX_HalInitClock(void)
 {
+    NX_UArch level;
+
+    /* gate counter 2 on with speaker off, count from 65536 and wrap */
+    IO_Out8(PIT_SYSTEM_CTRL, (IO_In8(PIT_SYSTEM_CTRL) & ~PIT_SPEAKER_DATA) | PIT_COUNTER2_GATE);
     IO_Out8(PIT_CTRL, PIT_MODE_2 | PIT_MODE_MSB_LSB |
-            PIT_MODE_COUNTER_0 | PIT_MODE_BINARY);
-    IO_Out8(PIT_COUNTER0, (NX_U8) (COUNTER0_VALUE & 0xff));
-    IO_Out8(PIT_COUNTER0, (NX_U8) (COUNTER0_VALUE >> 8) & 0xff);
+            PIT_MODE_COUNTER_2 | PIT_MODE_BINARY);
+    IO_Out8(PIT_COUNTER2, 0);
+    IO_Out8(PIT_COUNTER2, 0);
 
     NX_Error err = NX_IRQ_Bind(IRQ_CLOCK, ClockHandler, NX_NULL, "Clock", 0);
     if (err != NX_EOK)
@@ -159,5 +303,16 @@ NX_INTERFACE NX_Error NX_HalInitClock(void)
         NX_LOG_E("IRQ unmask failed! %d", err);
         return NX_ERROR;
     }
+
+    /* start first event after unmasked, its edge not lost */
+    level = NX_IRQ_SaveLevel();
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+    lastTick = NX_HalClockNanosecond();
+    NX_HalClockSetEvent(1);
+#else
+    tickEvent = NX_HalClockNanosecond() + NANOSECOND_PER_TICK;
+    ClockProgramEvent();
+#endif
+    NX_IRQ_RestoreLevel(level);
     return NX_EOK;
 }
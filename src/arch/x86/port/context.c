@@ -14,10 +14,34 @@
 #include <interrupt.h>
 #include <base/debug.h>
 #include <base/irq.h>
+#include <base/thread.h>
+#include <tss.h>
 
 NX_IMPORT void NX_HalContextSwitchNext(NX_Addr nextSP);
 NX_IMPORT void NX_HalContextSwitchPrevNext(NX_Addr prevSP, NX_Addr nextSP);
 
+/**
+ * user thread traps into its kernel stack top set in tss, set it on every switch,
+ * page table switch may be skipped. running thread on core was set as next already.
+ */
+NX_PRIVATE void ContextSetKernelStack(void)
+{
+    NX_Thread *next = NX_ThreadSelf();
+    CPU_SetTssStack((NX_UArch)(next->stackBase + next->stackSize));
+}
+
+NX_PRIVATE void ContextSwitchNext(NX_Addr nextSP)
+{
+    ContextSetKernelStack();
+    NX_HalContextSwitchNext(nextSP);
+}
+
+NX_PRIVATE void ContextSwitchPrevNext(NX_Addr prevSP, NX_Addr nextSP)
+{
+    ContextSetKernelStack();
+    NX_HalContextSwitchPrevNext(prevSP, nextSP);
+}
+
 /**
  * any thread will come here when first start
  */
@@ -51,6 +75,6 @@ NX_PRIVATE void *NX_HalContextInit(void *startEntry, void *exitEntry, void *arg,
 NX_INTERFACE struct NX_ContextOps NX_ContextOpsInterface = 
 {
     .init           = NX_HalContextInit,
-    .switchNext     = NX_HalContextSwitchNext,
-    .switchPrevNext = NX_HalContextSwitchPrevNext,
+    .switchNext     = ContextSwitchNext,
+    .switchPrevNext = ContextSwitchPrevNext,
 };
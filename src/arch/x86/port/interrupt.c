@@ -219,28 +219,6 @@ NX_PRIVATE NX_Error NX_HalIrqAck(NX_IRQ_Number irqno)
     return NX_EOK;
 }
 
-NX_PRIVATE void NX_HalIrqEnable(void)
-{
-    NX_CASM("sti");
-}
-
-NX_PRIVATE void NX_HalIrqDisable(void)
-{
-    NX_CASM("cli");
-}
-
-NX_PRIVATE NX_UArch NX_HalIrqSaveLevel(void)
-{
-    NX_UArch level = 0;
-    NX_CASM("pushfl; popl %0; cli":"=g" (level): :"memory");
-    return level;
-}
-
-NX_PRIVATE void NX_HalIrqRestoreLevel(NX_UArch level)
-{
-    NX_CASM("pushl %0; popfl": :"g" (level):"memory", "cc");
-}
-
 NX_INTERFACE NX_IRQ_Controller NX_IRQ_ControllerInterface = 
 {
     .unmask = NX_HalIrqUnmask,
@@ -250,4 +228,5 @@ NX_INTERFACE NX_IRQ_Controller NX_IRQ_ControllerInterface =
     .disable = NX_HalIrqDisable,
     .saveLevel = NX_HalIrqSaveLevel,
     .restoreLevel = NX_HalIrqRestoreLevel,
+    .isEnabled = NX_HalIrqIsEnabled,
 };
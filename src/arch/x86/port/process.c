@@ -30,11 +30,13 @@ NX_IMPORT void NX_HalProcessEnterUserMode(NX_HalTrapFrame *frame);
 
 NX_PRIVATE NX_Error NX_HalProcessInitUserSpace(NX_Process *process, NX_Addr virStart, NX_Size size)
 {
-    void *table = NX_MemAlloc(NX_PAGE_SIZE);
+    /* page table allocated from page for reference count, core loaded it holds one */
+    void *table = NX_PageAlloc(1);
     if (table == NX_NULL)
     {
         return NX_ENOMEM;
     }
+    table = NX_Phy2Virt(table);
     NX_MemZero(table, NX_PAGE_SIZE);
     NX_MemCopy(table, NX_HalGetKernelPageTable(), NX_PAGE_SIZE);
     NX_MmuInit(&process->vmspace.mmu, table, virStart, size, 0);
@@ -48,18 +50,20 @@ NX_PRIVATE NX_Error NX_HalProcessFreePageTable(NX_Vmspace *vmspace)
     {
         return NX_EFAULT;
     }
-    NX_MemFree(vmspace->mmu.table);
+    NX_PageFree(NX_Virt2Phy(vmspace->mmu.table));
     return NX_EOK;
 }
 
-NX_PRIVATE NX_Error NX_HalProcessSwitchPageTable(void *pageTableVir)
+NX_PRIVATE NX_Error NX_HalProcessSwitchPageTable(NX_Vmspace *vmspace)
 {
-    NX_Thread *cur = NX_ThreadSelf();
-    /* need set new kernel esp as next thread */
-    CPU_SetTssStack((NX_UArch)(cur->stackBase + cur->stackSize));
-
+    /* no pcid without long mode, cr3 write flushes none-global tlb entries */
+    void *pageTableVir = vmspace != NX_NULL ? vmspace->mmu.table : NX_HalGetKernelPageTable();
     NX_Addr pageTablePhy = (NX_Addr)NX_Virt2Phy(pageTableVir);
-    NX_MmuSetPageTable(pageTablePhy);
+    /* single core flushed tlb when unmapped, no need reload same page table */
+    if (pageTablePhy != NX_MmuGetPageTable())
+    {
+        NX_MmuSetPageTable(pageTablePhy);
+    }
     return NX_EOK;
 }
 
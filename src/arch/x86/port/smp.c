@@ -12,10 +12,14 @@
 #include <base/smp.h>
 #define NX_LOG_NAME "Multi Core"
 #include <base/log.h>
+#include <segment.h>
 
-NX_UArch NX_HalCoreGetIndex(void)
+/**
+ * fs segment base is per cpu data in kernel
+ */
+void NX_HalCoreSetCpuLocal(void *cpu)
 {
-    return 0;
+    CPU_CpuLocalSet((NX_Addr)cpu);
 }
 
 NX_Error NX_HalCoreBootApp(NX_UArch bootCoreId)
@@ -29,9 +33,30 @@ NX_Error NX_HalCoreEnterApp(NX_UArch appCoreId)
     return NX_ENORES;
 }
 
+NX_Error NX_HalCoreSendIpi(NX_UArch coreId)
+{
+    return NX_ENORES;
+}
+
+/**
+ * sti takes effect after next instruction, no interrupt lost before hlt.
+ */
+void NX_HalCoreHalt(void)
+{
+    NX_CASM("sti; hlt; cli" : : : "memory");
+}
+
+void NX_HalCoreRelax(void)
+{
+    NX_CASM("pause" : : : "memory");
+}
+
 NX_INTERFACE struct NX_SMP_Ops NX_SMP_OpsInterface = 
 {
-    .getIdx = NX_HalCoreGetIndex,
+    .setCpuLocal = NX_HalCoreSetCpuLocal,
     .bootApp = NX_HalCoreBootApp,
     .enterApp = NX_HalCoreEnterApp,
+    .sendIpi = NX_HalCoreSendIpi,
+    .halt = NX_HalCoreHalt,
+    .cpuRelax = NX_HalCoreRelax,
 };
@@ -22,7 +22,8 @@
 #define DRV_NAME "cpu info device"
 #define DEV_NAME "cpuinfo"
 
-#define NX_CPUINFO_GET_CORES 1
+#define NX_CPUINFO_GET_CORES     1
+#define NX_CPUINFO_GET_IDLE_TIME 2  /* get idle time (ms) since boot of each core */
 
 typedef struct NX_CpuInfo
 {
@@ -55,13 +56,25 @@ NX_PRIVATE NX_Error CpuInfoRead(struct NX_Device *device, void *buf, NX_Offset o
 
 NX_PRIVATE NX_Error CpuInfoControl(struct NX_Device *device, NX_U32 cmd, void *arg)
 {
-    if (cmd != NX_CPUINFO_GET_CORES)
+    NX_U32 cores = NX_MULTI_CORES_NR;
+    NX_U32 idleTime[NX_MULTI_CORES_NR];
+    int i;
+
+    switch (cmd)
     {
+    case NX_CPUINFO_GET_CORES:
+        NX_CopyToUser(arg, (char *)&cores, sizeof(cores));
+        break;
+    case NX_CPUINFO_GET_IDLE_TIME:
+        for (i = 0; i < NX_MULTI_CORES_NR; i++)
+        {
+            idleTime[i] = NX_SMP_GetIdleTime(i);
+        }
+        NX_CopyToUser(arg, (char *)idleTime, sizeof(idleTime));
+        break;
+    default:
         return NX_EINVAL;
     }
-    NX_U32 cores = NX_MULTI_CORES_NR;
-
-    NX_CopyToUser(arg, (char *)&cores, sizeof(cores));
 
     return NX_EOK;
 }
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: sched control driver
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/driver.h>
+
+#ifdef CONFIG_NX_DRIVER_SCHEDCTL
+
+#define NX_LOG_NAME "sched control driver"
+#include <base/log.h>
+#include <base/fair.h>
+#include <base/clock.h>
+#include <base/uaccess.h>
+
+#define DRV_NAME "sched control device"
+#define DEV_NAME "schedctl"
+
+#define NX_SCHEDCTL_GET_FAIR 1  /* get fair class tunables (ms) */
+#define NX_SCHEDCTL_SET_FAIR 2  /* set fair class tunables (ms) */
+
+typedef struct NX_SchedCtlFair
+{
+    NX_U32 latency;
+    NX_U32 minGranularity;
+    NX_U32 wakeupGranularity;
+} NX_SchedCtlFair;
+
+NX_PRIVATE NX_Error SchedCtlControl(struct NX_Device *device, NX_U32 cmd, void *arg)
+{
+    NX_SchedFairTunables tunables;
+    NX_SchedCtlFair fair;
+
+    switch (cmd)
+    {
+    case NX_SCHEDCTL_GET_FAIR:
+        NX_SchedFairGetTunables(&tunables);
+        fair.latency = NX_ClockTickToMillisecond(tunables.latency);
+        fair.minGranularity = NX_ClockTickToMillisecond(tunables.minGranularity);
+        fair.wakeupGranularity = NX_ClockTickToMillisecond(tunables.wakeupGranularity);
+        NX_CopyToUser(arg, (char *)&fair, sizeof(fair));
+        break;
+    case NX_SCHEDCTL_SET_FAIR:
+        NX_CopyFromUser((char *)&fair, arg, sizeof(fair));
+        tunables.latency = NX_MillisecondToClockTick(fair.latency);
+        tunables.minGranularity = NX_MillisecondToClockTick(fair.minGranularity);
+        tunables.wakeupGranularity = NX_MillisecondToClockTick(fair.wakeupGranularity);
+        return NX_SchedFairSetTunables(&tunables);
+    default:
+        return NX_EINVAL;
+    }
+
+    return NX_EOK;
+}
+
+NX_PRIVATE NX_DriverOps SchedCtlDriverOps = {
+    .control = SchedCtlControl,
+};
+
+NX_PRIVATE void SchedCtlDriverInit(void)
+{
+    NX_Device *device;
+    NX_Driver *driver = NX_DriverCreate(DRV_NAME, NX_DEVICE_TYPE_VIRT, 0, &SchedCtlDriverOps);
+    if (driver == NX_NULL)
+    {
+        NX_LOG_E("create driver failed!");
+        return;
+    }
+
+    if (NX_DriverAttachDevice(driver, DEV_NAME, &device) != NX_EOK)
+    {
+        NX_LOG_E("attach device %s failed!", DEV_NAME);
+        NX_DriverDestroy(driver);
+        return;
+    }
+
+    if (NX_DriverRegister(driver) != NX_EOK)
+    {
+        NX_LOG_E("register driver %s failed!", DRV_NAME);
+        NX_DriverDetachDevice(driver, DEV_NAME);
+        NX_DriverDestroy(driver);
+        return;
+    }
+
+    NX_LOG_I("init %s driver success!", DRV_NAME);
+}
+
+NX_PRIVATE void SchedCtlDriverExit(void)
+{
+    NX_DriverCleanup(DRV_NAME);
+}
+
+NX_DRV_INIT(SchedCtlDriverInit);
+NX_DRV_EXIT(SchedCtlDriverExit);
+
+#endif
@@ -24,6 +24,7 @@
 #include <base/block.h>
 #include <base/thread.h>
 #include <base/process.h>
+#include <base/rwlock.h>
 
 #define VFS_GET_FILE_TABLE() NX_ThreadGetFileTable(NX_ThreadSelf())
 
@@ -32,7 +33,7 @@ NX_PRIVATE NX_LIST_HEAD(fileSystemListHead);
 NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(fileSystemLock);
 
 NX_PRIVATE NX_List fileSystemMountList;
-NX_PRIVATE NX_Mutex fileSystemMountLock;
+NX_PRIVATE NX_RwLock fileSystemMountLock; /* mount list read on every path lookup */
 NX_PRIVATE NX_List fileSystemNodeList[NX_VFS_NODE_HASH_SIZE];
 NX_PRIVATE NX_Mutex fileSystemNodeLock[NX_VFS_NODE_HASH_SIZE];
 
@@ -136,7 +137,7 @@ NX_PRIVATE NX_Error VfsFindRoot(const char * path, NX_VfsMount ** mp, char ** ro
 		return NX_EINVAL;
     }
 
-	NX_MutexLock(&fileSystemMountLock);
+	NX_RwLockRead(&fileSystemMountLock);
 	NX_ListForEachEntry(pos, &fileSystemMountList, link)
 	{
 		len = CountMatch(path, pos->path);
@@ -146,7 +147,7 @@ NX_PRIVATE NX_Error VfsFindRoot(const char * path, NX_VfsMount ** mp, char ** ro
 			m = pos;
 		}
 	}
-	NX_MutexUnlock(&fileSystemMountLock);
+	NX_RwUnlockRead(&fileSystemMountLock);
 
 	if(!m)
     {
@@ -740,12 +741,12 @@ NX_Error NX_VfsMountFileSystem(const char * dev, const char * path, const char *
 		m->root->mode &= ~(NX_VFS_S_IWUSR | NX_VFS_S_IWGRP | NX_VFS_S_IWOTH);
     }
 
-	NX_MutexLock(&fileSystemMountLock);
+	NX_RwLockWrite(&fileSystemMountLock);
 	NX_ListForEachEntry(tm, &fileSystemMountList, link)
 	{
 		if(!NX_StrCmp(tm->path, absPath) || ((dev != NX_NULL) && (tm->dev == bdev)))
 		{
-			NX_MutexUnlock(&fileSystemMountLock);
+			NX_RwUnlockWrite(&fileSystemMountLock);
 			NX_MutexLock(&m->lock);
 			m->fs->unmount(m);
 			NX_MutexUnlock(&m->lock);
@@ -759,7 +760,7 @@ NX_Error NX_VfsMountFileSystem(const char * dev, const char * path, const char *
 		}
 	}
 	NX_ListAdd(&m->link, &fileSystemMountList);
-	NX_MutexUnlock(&fileSystemMountLock);
+	NX_RwUnlockWrite(&fileSystemMountLock);
 
 	return NX_EOK;
 }
@@ -776,7 +777,7 @@ NX_Error NX_VfsUnmountFileSystem(const char * path)
         return err;
     }
 
-	NX_MutexLock(&fileSystemMountLock);
+	NX_RwLockWrite(&fileSystemMountLock);
 	found = 0;
 	NX_ListForEachEntry(m, &fileSystemMountList, link)
 	{
@@ -788,16 +789,16 @@ NX_Error NX_VfsUnmountFileSystem(const char * path)
 	}
 	if(!found)
 	{
-		NX_MutexUnlock(&fileSystemMountLock);
+		NX_RwUnlockWrite(&fileSystemMountLock);
 		return NX_ENOSRCH;
 	}
 	if(NX_AtomicGet(&m->refcnt) > 1)
 	{
-		NX_MutexUnlock(&fileSystemMountLock);
+		NX_RwUnlockWrite(&fileSystemMountLock);
 		return NX_EBUSY;
 	}
 	NX_ListDel(&m->link);
-	NX_MutexUnlock(&fileSystemMountLock);
+	NX_RwUnlockWrite(&fileSystemMountLock);
 
 	NX_MutexLock(&m->lock);
 	err = m->fs->msync(m);
@@ -823,11 +824,21 @@ NX_Error NX_VfsUnmountFileSystem(const char * path)
 
 NX_Error NX_VfsSync(void)
 {
-	NX_VfsMount * m;
+	NX_VfsMount * m, * next;
     NX_Error err;
-	NX_MutexLock(&fileSystemMountLock);
-	NX_ListForEachEntry(m, &fileSystemMountList, link)
+
+    /**
+     * msync sleeps on mount mutex and block io, never in mount spin lock.
+     * a reference held on mount while syncing keeps it from unmount,
+     * so it still links to the next one when lock taken again.
+     */
+	NX_RwLockRead(&fileSystemMountLock);
+	m = NX_ListFirstEntry(&fileSystemMountList, NX_VfsMount, link);
+	while (&m->link != &fileSystemMountList)
 	{
+		NX_AtomicAdd(&m->refcnt, 1);
+		NX_RwUnlockRead(&fileSystemMountLock);
+
 		NX_MutexLock(&m->lock);
 		err = m->fs->msync(m);
 		if (err != NX_EOK)
@@ -835,8 +846,13 @@ NX_Error NX_VfsSync(void)
             NX_LOG_W("mount point path %s sync error! with %d", m->path, err);
         }
         NX_MutexUnlock(&m->lock);
+
+		NX_RwLockRead(&fileSystemMountLock);
+		next = NX_ListNextEntry(m, link);
+		NX_AtomicSub(&m->refcnt, 1);
+		m = next;
 	}
-	NX_MutexUnlock(&fileSystemMountLock);
+	NX_RwUnlockRead(&fileSystemMountLock);
 
 	return NX_EOK;
 }
@@ -849,7 +865,7 @@ NX_VfsMount * NX_VfsGetMount(int index)
 	if(index < 0)
 		return NX_NULL;
 
-	NX_MutexLock(&fileSystemMountLock);
+	NX_RwLockRead(&fileSystemMountLock);
 	NX_ListForEachEntry(m, &fileSystemMountList, link)
 	{
 		if(!index)
@@ -859,7 +875,7 @@ NX_VfsMount * NX_VfsGetMount(int index)
 		}
 		index--;
 	}
-	NX_MutexUnlock(&fileSystemMountLock);
+	NX_RwUnlockRead(&fileSystemMountLock);
 
 	if(!found)
     {
@@ -873,12 +889,12 @@ int NX_VfsGetMountCount(void)
 	NX_VfsMount * m;
 	int ret = 0;
 
-	NX_MutexLock(&fileSystemMountLock);
+	NX_RwLockRead(&fileSystemMountLock);
 	NX_ListForEachEntry(m, &fileSystemMountList, link)
 	{
 		ret++;
 	}
-	NX_MutexUnlock(&fileSystemMountLock);
+	NX_RwUnlockRead(&fileSystemMountLock);
 
 	return ret;
 }
@@ -2041,7 +2057,7 @@ NX_PRIVATE void NX_VfsInit(void)
 	int i;
 
 	NX_ListInit(&fileSystemMountList);
-	NX_MutexInit(&fileSystemMountLock);
+	NX_RwLockInit(&fileSystemMountLock);
 
 	for(i = 0; i < NX_VFS_NODE_HASH_SIZE; i++)
 	{
@@ -0,0 +1,42 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: address space id for tlb tagging
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __MM_ASID__
+#define __MM_ASID__
+
+#include <nxos.h>
+#include <base/mmu.h>
+
+/* kernel page table runs in asid 0, never allocated to user space */
+#define NX_ASID_KERNEL      0
+
+/* asid bits used at most, sv39/sv48 satp has 16 */
+#define NX_ASID_MAX_BITS    16
+
+/* tlb flush needed before run with the asid */
+#define NX_ASID_FLUSH_NONE  0
+#define NX_ASID_FLUSH_ASID  1   /* flush entries of this asid only */
+#define NX_ASID_FLUSH_ALL   2   /* flush whole tlb */
+
+#ifdef CONFIG_NX_MMU_ASID
+/**
+ * asid is allocated to address space when it is switched to in a new generation.
+ * when all asids in generation used up, a new generation starts and each core
+ * flushes whole tlb before its next switch, so asids of old generation can be reused.
+ */
+void NX_AsidInit(NX_UArch bits);
+NX_UArch NX_AsidBits(void);
+NX_UArch NX_AsidSwitch(NX_Mmu *mmu, int *flush);
+NX_UArch NX_AsidGet(NX_Mmu *mmu);
+void NX_AsidMarkStale(NX_Mmu *mmu);
+#endif
+
+#endif /* __MM_ASID__ */
@@ -24,6 +24,8 @@ typedef struct NX_Atomic NX_Atomic;
 #define NX_ATOMIC_INIT_VALUE(val) {val}
 #define NX_ATOMIC_DEFINE(name, val) NX_Atomic name = NX_ATOMIC_INIT_VALUE(val);
 
+#include <arch/atomic.h>
+
 struct NX_AtomicOps
 {
     void (*set)(NX_Atomic *atomic, NX_IArch value);
@@ -36,10 +38,24 @@ struct NX_AtomicOps
     void (*clearMask)(NX_Atomic *atomic, NX_IArch mask);
     NX_IArch (*swap)(NX_Atomic *atomic, NX_IArch newValue);
     NX_IArch (*cas)(NX_Atomic *atomic, NX_IArch old, NX_IArch newValue);
+    NX_IArch (*fetchAdd)(NX_Atomic *atomic, NX_IArch value);  /* return value before add */
 };
 
 NX_INTERFACE NX_IMPORT struct NX_AtomicOps NX_AtomicOpsInterface;
 
+#ifdef CONFIG_NX_HAL_INLINE
+#define NX_AtomicSet(atomic, value)         NX_HalAtomicSet(atomic, value)
+#define NX_AtomicGet(atomic)                NX_HalAtomicGet(atomic)
+#define NX_AtomicAdd(atomic, value)         NX_HalAtomicAdd(atomic, value)
+#define NX_AtomicSub(atomic, value)         NX_HalAtomicSub(atomic, value)
+#define NX_AtomicInc(atomic)                NX_HalAtomicInc(atomic)
+#define NX_AtomicDec(atomic)                NX_HalAtomicDec(atomic)
+#define NX_AtomicSetMask(atomic, mask)      NX_HalAtomicSetMask(atomic, mask)
+#define NX_AtomicClearMask(atomic, mask)    NX_HalAtomicClearMask(atomic, mask)
+#define NX_AtomicSwap(atomic, newValue)     NX_HalAtomicSwap(atomic, newValue)
+#define NX_AtomicCAS(atomic, old, newValue) NX_HalAtomicCAS(atomic, old, newValue)
+#define NX_AtomicFetchAdd(atomic, value)    NX_HalAtomicFetchAdd(atomic, value)
+#else
 #define NX_AtomicSet(atomic, value)         NX_AtomicOpsInterface.set(atomic, value)
 #define NX_AtomicGet(atomic)                NX_AtomicOpsInterface.get(atomic)
 #define NX_AtomicAdd(atomic, value)         NX_AtomicOpsInterface.add(atomic, value)
@@ -50,5 +66,7 @@ NX_INTERFACE NX_IMPORT struct NX_AtomicOps NX_AtomicOpsInterface;
 #define NX_AtomicClearMask(atomic, mask)    NX_AtomicOpsInterface.clearMask(atomic, mask)
 #define NX_AtomicSwap(atomic, newValue)     NX_AtomicOpsInterface.swap(atomic, newValue)
 #define NX_AtomicCAS(atomic, old, newValue) NX_AtomicOpsInterface.cas(atomic, old, newValue)
+#define NX_AtomicFetchAdd(atomic, value)    NX_AtomicOpsInterface.fetchAdd(atomic, value)
+#endif
 
 #endif /* __XBOOK_ATOMIC__ */
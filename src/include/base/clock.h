@@ -24,6 +24,11 @@
 #error "config ticks range in [1~1000]"
 #endif
 
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+/* max ticks a core sleep without clock event */
+#define NX_CLOCK_TICKLESS_MAX_TICKS NX_TICKS_PER_SECOND
+#endif
+
 #define NX_TICKS_PER_MILLISECOND (1000 / NX_TICKS_PER_SECOND)
 #define NX_MILLISECOND_TO_TICKS(msec) ((msec) / NX_TICKS_PER_MILLISECOND)
 #define NX_TICKS_TO_MILLISECOND(ticks) ((ticks) * NX_TICKS_PER_MILLISECOND)
@@ -34,6 +39,15 @@ typedef NX_UArch NX_ClockTick;
 NX_ClockTick NX_ClockTickGet(void);
 void NX_ClockTickSet(NX_ClockTick tick);
 void NX_ClockTickGo(void);
+void NX_ClockTickAdvance(NX_ClockTick ticks);
+
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+NX_ClockTick NX_ClockNextEventTicks(void);
+void NX_ClockEventUpdate(void);
+void NX_ClockEventNotify(NX_UArch coreId);
+#else
+NX_INLINE void NX_ClockEventNotify(NX_UArch coreId) {}
+#endif
 
 NX_Error NX_ClockTickDelay(NX_ClockTick ticks);
 
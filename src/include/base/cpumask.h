@@ -0,0 +1,33 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: cpu mask, one bit per core
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __SCHED_CPUMASK___
+#define __SCHED_CPUMASK___
+
+#include <nxos.h>
+#include <base/bitops.h>
+
+#if NX_MULTI_CORES_NR > 32
+#error "cpu mask support 32 cores at most"
+#endif
+
+typedef NX_U32 NX_CpuMask;
+
+#define NX_CPUMASK_NONE 0U
+#define NX_CPUMASK_ALL ((NX_CpuMask)(((NX_U64)1 << NX_MULTI_CORES_NR) - 1))
+
+#define NX_CpuMaskCore(coreId) ((NX_CpuMask)1 << (coreId))
+#define NX_CpuMaskTest(mask, coreId) (((mask) >> (coreId)) & 1U)
+
+/* first core in mask, NX_MULTI_CORES_NR if empty */
+#define NX_CpuMaskFirst(mask) ((mask) ? (NX_UArch)(NX_FFS(mask) - 1) : NX_MULTI_CORES_NR)
+
+#endif /* __SCHED_CPUMASK___ */
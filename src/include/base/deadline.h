@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: deadline scheduling class
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __SCHED_DEADLINE___
+#define __SCHED_DEADLINE___
+
+#include <nxos.h>
+#include <base/clock.h>
+#include <base/timer.h>
+#include <base/cpumask.h>
+
+#ifdef CONFIG_NX_SCHED_DEADLINE_BANDWIDTH
+#define NX_SCHED_DEADLINE_BANDWIDTH CONFIG_NX_SCHED_DEADLINE_BANDWIDTH
+#else
+#define NX_SCHED_DEADLINE_BANDWIDTH 950
+#endif
+
+#if NX_SCHED_DEADLINE_BANDWIDTH > 1000
+#error "deadline bandwidth is per mille of core, must less equal than 1000"
+#endif
+
+/**
+ * deadline thread gets `runtime` ticks every `period` ticks, used before `deadline` ticks
+ * from period start. ready deadline threads run earliest deadline first (EDF) and before
+ * any priority thread. the budget is kept by constant bandwidth server (CBS): thread is
+ * throttled when budget used up, and replenished at next period.
+ */
+struct NX_ThreadDeadline
+{
+    NX_ClockTick runtime;       /* budget each period, 0 means not a deadline thread */
+    NX_ClockTick deadline;      /* relative deadline */
+    NX_ClockTick period;
+    NX_ClockTick absDeadline;   /* absolute deadline of current period */
+    NX_ClockTick leftRuntime;   /* budget left in current period */
+    NX_U32 bandwidth;           /* runtime / period in per mille */
+    NX_Bool throttled;          /* budget used up, not on ready list until replenished */
+    NX_U32 savedPriority;       /* fixed priority before join deadline class */
+    NX_CpuMask savedAffinity;   /* core affinity before join deadline class */
+    NX_UArch core;              /* core admitted the thread */
+    NX_Timer timer;             /* replenish timer */
+};
+typedef struct NX_ThreadDeadline NX_ThreadDeadline;
+
+/* tick a is before tick b, tick counter may wrap */
+#define NX_DeadlineBefore(a, b) ((NX_IArch)((a) - (b)) < 0)
+
+struct NX_Thread;
+
+#ifdef CONFIG_NX_SCHED_DEADLINE
+#define NX_ThreadIsDeadline(thread) ((thread)->dl.runtime != 0)
+
+NX_Error NX_ThreadSetDeadline(struct NX_Thread *thread, NX_ClockTick runtime, NX_ClockTick deadline, NX_ClockTick period);
+
+void NX_SchedDeadlineInit(struct NX_Thread *thread);
+void NX_SchedDeadlineExit(struct NX_Thread *thread);
+void NX_SchedDeadlineReadyRun(struct NX_Thread *thread, int flags);
+void NX_SchedDeadlineTick(struct NX_Thread *thread, NX_ClockTick ticks);
+#else
+#define NX_ThreadIsDeadline(thread) NX_False
+#define NX_ThreadSetDeadline(thread, runtime, deadline, period) NX_ENOFUNC
+
+#define NX_SchedDeadlineInit(thread)
+#define NX_SchedDeadlineExit(thread)
+#define NX_SchedDeadlineTick(thread, ticks)
+#endif
+
+#endif /* __SCHED_DEADLINE___ */
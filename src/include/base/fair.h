@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: fair scheduling class for time-sharing threads
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __SCHED_FAIR___
+#define __SCHED_FAIR___
+
+#include <nxos.h>
+#include <base/clock.h>
+
+#ifdef CONFIG_NX_SCHED_FAIR_LATENCY
+#define NX_SCHED_FAIR_LATENCY CONFIG_NX_SCHED_FAIR_LATENCY
+#else
+#define NX_SCHED_FAIR_LATENCY 6
+#endif
+
+#ifdef CONFIG_NX_SCHED_FAIR_MIN_GRANULARITY
+#define NX_SCHED_FAIR_MIN_GRANULARITY CONFIG_NX_SCHED_FAIR_MIN_GRANULARITY
+#else
+#define NX_SCHED_FAIR_MIN_GRANULARITY 1
+#endif
+
+#ifdef CONFIG_NX_SCHED_FAIR_WAKEUP_GRANULARITY
+#define NX_SCHED_FAIR_WAKEUP_GRANULARITY CONFIG_NX_SCHED_FAIR_WAKEUP_GRANULARITY
+#else
+#define NX_SCHED_FAIR_WAKEUP_GRANULARITY 1
+#endif
+
+/* weight of normal priority, the vruntime of it grows as fast as ticks */
+#define NX_SCHED_FAIR_WEIGHT_NORMAL     1024
+
+/* vruntime units of one tick at normal weight */
+#define NX_SCHED_FAIR_VRUNTIME_SCALE    64
+
+/* max latency tunable, keep vruntime delta math in 32 bits */
+#define NX_SCHED_FAIR_MAX_LATENCY       (NX_TICKS_PER_SECOND * 10)
+
+/**
+ * fair class tunables, all in clock ticks
+ */
+struct NX_SchedFairTunables
+{
+    NX_ClockTick latency;           /* every ready fair thread runs once in latency */
+    NX_ClockTick minGranularity;    /* min timeslice of fair thread */
+    NX_ClockTick wakeupGranularity; /* vruntime lead the woken thread needs to preempt */
+};
+typedef struct NX_SchedFairTunables NX_SchedFairTunables;
+
+struct NX_Thread;
+
+#ifdef CONFIG_NX_SCHED_FAIR
+/**
+ * time-sharing priorities LOW..HIGH run in fair class: each thread has a vruntime growing
+ * slower with larger weight of its priority, ready thread with smallest vruntime runs first.
+ */
+#define NX_ThreadIsFair(thread) ((thread)->priority >= NX_THREAD_PRIORITY_LOW && \
+    (thread)->priority <= NX_THREAD_PRIORITY_HIGH)
+
+NX_U32 NX_SchedFairWeight(NX_U32 priority);
+NX_U64 NX_SchedFairDelta(NX_ClockTick ticks, NX_U32 weight);
+NX_ClockTick NX_SchedFairSlice(NX_U32 weight, NX_U32 load);
+NX_U64 NX_SchedFairSleeperCredit(void);
+NX_U64 NX_SchedFairWakeupLead(void);
+
+void NX_SchedFairTick(struct NX_Thread *thread, NX_ClockTick ticks);
+
+void NX_SchedFairGetTunables(NX_SchedFairTunables *tunables);
+NX_Error NX_SchedFairSetTunables(NX_SchedFairTunables *tunables);
+#else
+#define NX_ThreadIsFair(thread) NX_False
+
+#define NX_SchedFairTick(thread, ticks)
+#endif
+
+#endif /* __SCHED_FAIR___ */
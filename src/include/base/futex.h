@@ -0,0 +1,33 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: futex, wait on user address
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __IPC_FUTEX_H__
+#define __IPC_FUTEX_H__
+
+#include <nxos.h>
+
+#define NX_FUTEX_HASH_NR 64 /* must be power of 2 */
+
+#define NX_FUTEX_WAKE_ALL ((NX_Size)-1)
+
+/**
+ * block current thread on addr if *addr still equal to value,
+ * return NX_EAGAIN if value changed before block.
+ */
+NX_Error NX_FutexWait(NX_U32 *addr, NX_U32 value);
+
+/**
+ * wakeup at most count threads waiting on addr,
+ * return waked count in outWaked if not null.
+ */
+NX_Error NX_FutexWake(NX_U32 *addr, NX_Size count, NX_Size *outWaked);
+
+#endif /* __IPC_FUTEX_H__ */
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: high resolution one shot timer
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __MODS_TIME_HRTIMER__
+#define __MODS_TIME_HRTIMER__
+
+#include <nxos.h>
+
+#define NX_NANOSECOND_PER_SECOND        1000000000ULL
+#define NX_NANOSECOND_PER_MILLISECOND   1000000ULL
+
+/* no hrtimer event */
+#define NX_HRTIMER_NEVER ((NX_U64)-1)
+
+enum NX_HrTimerState
+{
+    NX_HRTIMER_INACTIVE = 0,    /* not in queue */
+    NX_HRTIMER_ENQUEUED,        /* in queue waiting for expires */
+};
+typedef enum NX_HrTimerState NX_HrTimerState;
+
+struct NX_HrTimer
+{
+    /* pairing heap node, prev is left sibling, or parent for first child */
+    struct NX_HrTimer *child;
+    struct NX_HrTimer *next;
+    struct NX_HrTimer *prev;
+
+    NX_U64 expires;             /* absolute nanoseconds */
+    NX_HrTimerState state;
+    NX_VOLATILE NX_UArch core;  /* core of hrtimer base armed on */
+    void (*handler)(struct NX_HrTimer *, void *arg);
+    void *arg;
+};
+typedef struct NX_HrTimer NX_HrTimer;
+
+NX_Error NX_HrTimerInit(NX_HrTimer *hrtimer, void (*handler)(struct NX_HrTimer *, void *arg), void *arg);
+NX_Error NX_HrTimerStart(NX_HrTimer *hrtimer, NX_U64 nanoseconds);
+NX_Error NX_HrTimerCancel(NX_HrTimer *hrtimer);
+
+NX_U64 NX_HrTimerNanosecondGet(void);
+
+void NX_HrTimersInit(void);
+void NX_HrTimerRun(void);
+
+#endif  /* __MODS_TIME_HRTIMER__ */
@@ -15,6 +15,7 @@
 #include <nxos.h>
 #include <base/list.h>
 #include <base/atomic.h>
+#include <arch/irq.h>
 
 #ifdef CONFIG_NX_IRQ_NAME_LEN
 #define NX_IRQ_NAME_LEN CONFIG_NX_IRQ_NAME_LEN
@@ -44,6 +45,7 @@ struct NX_IRQ_Controller
     void (*disable)(void);
     NX_UArch (*saveLevel)(void);
     void (*restoreLevel)(NX_UArch level);
+    NX_Bool (*isEnabled)(void);
 };
 typedef struct NX_IRQ_Controller NX_IRQ_Controller;
 
@@ -81,10 +83,19 @@ NX_Error NX_IRQ_Mask(NX_IRQ_Number irqno);
 
 NX_Error NX_IRQ_Handle(NX_IRQ_Number irqno);
 
+#ifdef CONFIG_NX_HAL_INLINE
+#define NX_IRQ_Enable()            NX_HalIrqEnable()
+#define NX_IRQ_Disable()           NX_HalIrqDisable()
+#define NX_IRQ_SaveLevel()         NX_HalIrqSaveLevel()
+#define NX_IRQ_RestoreLevel(level) NX_HalIrqRestoreLevel(level)
+#define NX_IRQ_IsEnabled()         NX_HalIrqIsEnabled()
+#else
 #define NX_IRQ_Enable()            NX_IRQ_ControllerInterface.enable()
 #define NX_IRQ_Disable()           NX_IRQ_ControllerInterface.disable()
 #define NX_IRQ_SaveLevel()         NX_IRQ_ControllerInterface.saveLevel()
 #define NX_IRQ_RestoreLevel(level) NX_IRQ_ControllerInterface.restoreLevel(level)
+#define NX_IRQ_IsEnabled()         NX_IRQ_ControllerInterface.isEnabled()
+#endif
 
 void NX_IRQ_Init(void);
 
@@ -14,6 +14,7 @@
 
 #include <nxos.h>
 #include <arch/mmu.h>
+#include <base/atomic.h>
 
 struct NX_Mmu
 {
@@ -21,6 +22,10 @@ struct NX_Mmu
     NX_Addr virStart; /* vir addr start */
     NX_Addr virEnd;   /* vir addr end */
     NX_Addr earlyEnd; /* early map end(only for kernel self map) */
+#ifdef CONFIG_NX_MMU_ASID
+    NX_U64 asid;        /* asid number with its generation, 0 means not allocated */
+    NX_Atomic tlbStale; /* cores may cache stale tlb entries of this space */
+#endif
 };
 typedef struct NX_Mmu NX_Mmu;
 
@@ -15,10 +15,22 @@
 
 #include <nxos.h>
 #include <base/spin.h>
+#include <base/list.h>
+#include <base/atomic.h>
+
+/* max times spin on mutex when owner running on other core */
+#define NX_MUTEX_SPIN_COUNT 1000
+
+struct NX_Thread;
 
 struct NX_Mutex
 {
-    NX_Spin lock;  /* lock for mutex value */
+    NX_Atomic value;    /* 1 locked, 0 unlocked */
+    struct NX_Thread *owner;   /* thread hold the mutex */
+    NX_Spin lock;  /* lock for owner and wait list */
+    NX_List waitList;   /* threads wait for mutex, FIFO */
+    NX_List ownerList;  /* on owner mutex list when owner inherit priority from it */
+    NX_U32 ceiling;     /* priority ceiling, 0 means no ceiling */
     NX_U32 magic;  /* magic for mutex init */  
 };
 typedef struct NX_Mutex NX_Mutex;
@@ -29,5 +41,7 @@ NX_Error NX_MutexLock(NX_Mutex *mutex);
 NX_Error NX_MutexTryLock(NX_Mutex *mutex);
 NX_Error NX_MutexUnlock(NX_Mutex *mutex);
 NX_Error NX_MutexState(NX_Mutex *mutex);
+NX_Error NX_MutexSetCeiling(NX_Mutex *mutex, NX_U32 ceiling);
+void NX_MutexThreadExit(struct NX_Thread *thread);
 
 #endif /* __SCHED_MUTEX___ */
@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: kernel preempt count
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __SCHED_PREEMPT___
+#define __SCHED_PREEMPT___
+
+#include <nxos.h>
+
+#ifdef CONFIG_NX_PREEMPT
+/**
+ * each thread has a preempt count, spin lock hold it above zero.
+ * thread only preempted when count is zero, pending preempt taken when count drop to zero.
+ */
+void NX_PreemptDisable(void);
+void NX_PreemptEnable(void);
+NX_U32 NX_PreemptCount(void);
+#else
+#define NX_PreemptDisable()
+#define NX_PreemptEnable()
+#define NX_PreemptCount() 0
+#endif
+
+#endif /* __SCHED_PREEMPT___ */
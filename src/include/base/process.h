@@ -67,7 +67,7 @@ typedef struct NX_TlsArea
 struct NX_ProcessOps
 {
     NX_Error (*initUserSpace)(NX_Process *process, NX_Addr virStart, NX_Size size);
-    NX_Error (*switchPageTable)(void *pageTable);
+    NX_Error (*switchPageTable)(NX_Vmspace *vmspace); /* NX_NULL switch to kernel page table */
     void *(*getKernelPageTable)(void);
     void (*executeUser)(const void *text, void *userStack, void *kernelStack, void *args);
     void (*executeUserThread)(const void *text, void *userStack, void *kernelStack, void *arg);
@@ -79,7 +79,7 @@ struct NX_ProcessOps
 NX_INTERFACE NX_IMPORT struct NX_ProcessOps NX_ProcessOpsInterface; 
 
 #define NX_ProcessInitUserSpace(process, virStart, size)            NX_ProcessOpsInterface.initUserSpace(process, virStart, size)
-#define NX_ProcessSwitchPageTable(pageTable)                        NX_ProcessOpsInterface.switchPageTable(pageTable)
+#define NX_ProcessSwitchPageTable(vmspace)                          NX_ProcessOpsInterface.switchPageTable(vmspace)
 #define NX_ProcessGetKernelPageTable()                              NX_ProcessOpsInterface.getKernelPageTable()
 #define NX_ProcessExecuteUser(text, userStack, kernelStack, args)   NX_ProcessOpsInterface.executeUser(text, userStack, kernelStack, args)
 #define NX_ProcessExecuteUserThread(text, userStack, kernelStack, arg) \
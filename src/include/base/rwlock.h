@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: reader-writer spin lock
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __SCHED_RWLOCK___
+#define __SCHED_RWLOCK___
+
+#include <nxos.h>
+#include <base/atomic.h>
+
+#define NX_RWLOCK_MAGIC 0x10000004
+#define NX_RWLOCK_WRITER (-1)   /* value when writer holding the lock */
+
+/**
+ * many readers or one writer hold the lock.
+ * readers wait when writer waiting, avoid writer starvation.
+ * not recursive: nested read on a core holding read deadlocks once a writer is waiting,
+ * so never call a function taking the same lock inside the read section.
+ */
+struct NX_RwLock
+{
+    NX_Atomic value;    /* > 0 readers holding, 0 free, NX_RWLOCK_WRITER writer holding */
+    NX_Atomic writerWaiting;    /* writers waiting for the lock */
+#ifdef CONFIG_NX_DEBUG
+    NX_U32 magic;  /* magic for rwlock init */
+#endif
+};
+typedef struct NX_RwLock NX_RwLock;
+
+#ifdef CONFIG_NX_DEBUG
+#define NX_RWLOCK_DEFINE(name) NX_RwLock name = {NX_ATOMIC_INIT_VALUE(0), NX_ATOMIC_INIT_VALUE(0), NX_RWLOCK_MAGIC}
+#else
+#define NX_RWLOCK_DEFINE(name) NX_RwLock name = {NX_ATOMIC_INIT_VALUE(0), NX_ATOMIC_INIT_VALUE(0)}
+#endif
+
+NX_Error NX_RwLockInit(NX_RwLock *lock);
+NX_Error NX_RwLockTryRead(NX_RwLock *lock);
+NX_Error NX_RwLockRead(NX_RwLock *lock);
+NX_Error NX_RwUnlockRead(NX_RwLock *lock);
+NX_Error NX_RwLockTryWrite(NX_RwLock *lock);
+NX_Error NX_RwLockWrite(NX_RwLock *lock);
+NX_Error NX_RwUnlockWrite(NX_RwLock *lock);
+NX_Error NX_RwLockReadIRQ(NX_RwLock *lock, NX_UArch *level);
+NX_Error NX_RwUnlockReadIRQ(NX_RwLock *lock, NX_UArch level);
+NX_Error NX_RwLockWriteIRQ(NX_RwLock *lock, NX_UArch *level);
+NX_Error NX_RwUnlockWriteIRQ(NX_RwLock *lock, NX_UArch level);
+NX_Error NX_RwLockState(NX_RwLock *lock);
+
+#endif /* __SCHED_RWLOCK___ */
@@ -18,10 +18,12 @@
 
 #define NX_SCHED_HEAD          0x01
 #define NX_SCHED_TAIL          0x02
+#define NX_SCHED_MIGRATED      0x04    /* moved from other core, vruntime is lag to its min */
 
 void NX_SchedToFirstThread(void);
 void NX_SchedInterruptDisabled(NX_UArch irqLevel);
 void NX_SchedLockedIRQ(NX_UArch irqLevel, NX_Spin *lock);
+void NX_SchedFinishSwitch(void);
 void NX_SchedYield(void);
 void NX_ReSchedCheck(void);
 void NX_SchedExit(void);
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: sequence lock for small data read often
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#ifndef __SCHED_SEQLOCK___
+#define __SCHED_SEQLOCK___
+
+#include <nxos.h>
+#include <base/spin.h>
+#include <base/smp.h>
+#include <base/barrier.h>
+
+/**
+ * writer make sequence odd while writing, reader never lock,
+ * only retry when sequence changed during read.
+ */
+struct NX_SeqLock
+{
+    NX_VOLATILE NX_UArch sequence;
+    NX_Spin lock;   /* lock between writers */
+};
+typedef struct NX_SeqLock NX_SeqLock;
+
+#define NX_SEQLOCK_DEFINE(name) NX_SeqLock name = {0, NX_SPIN_INIT_VALUE(0)}
+
+NX_INLINE void NX_SeqLockInit(NX_SeqLock *seq)
+{
+    seq->sequence = 0;
+    NX_SpinInit(&seq->lock);
+}
+
+NX_INLINE NX_UArch NX_SeqReadBegin(NX_SeqLock *seq)
+{
+    NX_UArch sequence;
+
+    while ((sequence = seq->sequence) & 1) /* writer writing */
+    {
+        NX_SMP_CpuRelax();
+    }
+    NX_MemoryBarrierRead();
+    return sequence;
+}
+
+/**
+ * return NX_True if data changed during read, need read again
+ */
+NX_INLINE NX_Bool NX_SeqReadRetry(NX_SeqLock *seq, NX_UArch sequence)
+{
+    NX_MemoryBarrierRead();
+    return seq->sequence != sequence ? NX_True : NX_False;
+}
+
+NX_INLINE void NX_SeqWriteLock(NX_SeqLock *seq, NX_UArch *level)
+{
+    NX_SpinLockIRQ(&seq->lock, level);
+    seq->sequence++;
+    NX_MemoryBarrierWrite();
+}
+
+NX_INLINE void NX_SeqWriteUnlock(NX_SeqLock *seq, NX_UArch level)
+{
+    NX_MemoryBarrierWrite();
+    seq->sequence++;
+    NX_SpinUnlockIRQ(&seq->lock, level);
+}
+
+#endif /* __SCHED_SEQLOCK___ */
@@ -17,32 +17,79 @@
 #include <base/thread.h>
 #include <base/spin.h>
 #include <base/atomic.h>
+#include <arch/percpu.h>
+
+/**
+ * ready priority bitmap: one bit per priority, grouped into 32 bits words,
+ * the group word has one bit per non-empty word.
+ */
+#define NX_PRIORITY_BITMAP_WORDS NX_DIV_ROUND_UP(NX_THREAD_MAX_PRIORITY_NR, 32)
+
+#if NX_THREAD_MAX_PRIORITY_NR > 32 * 32
+#error "thread max priority must less equal than 1024"
+#endif
+
+/* load of one runnable thread in core load average */
+#define NX_SMP_LOAD_SCALE 1024
+
+/* inter-processor interrupt types */
+#define NX_SMP_IPI_RESCHED  0x01    /* ask core to reschedule */
+#define NX_SMP_IPI_CLOCK    0x02    /* ask core to reprogram clock event */
+#define NX_SMP_IPI_CALL     0x04    /* ask core to run function, caller waits it done */
 
 struct NX_Cpu
 {
-    NX_List threadReadyList[NX_THREAD_MAX_PRIORITY_NR];   /* list for thread ready to run */
+    struct NX_Cpu *self;    /* per cpu data read through arch register, keep words read by it in front */
+    NX_UArch coreId;        /* id of the core owns the data */
     NX_Thread *threadRunning;  /* the thread running on core */
+    NX_Thread *threadSwitchOut; /* thread switched out, flag cleared when switch finished */
+    NX_List threadReadyList[NX_THREAD_MAX_PRIORITY_NR];   /* list for thread ready to run */
+    NX_U32 readyPriorityGroup;  /* bit set means word in readyPriorityMap not zero */
+    NX_U32 readyPriorityMap[NX_PRIORITY_BITMAP_WORDS];    /* bit set means ready list not empty */
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    NX_List deadlineReadyList;  /* deadline threads ready, unordered */
+    NX_Thread *deadlineReadyRoot;   /* heap of deadline threads ready, earliest deadline at root */
+    NX_U32 deadlineBandwidth;   /* deadline bandwidth admitted on core, per mille */
+#endif
+#ifdef CONFIG_NX_SCHED_FAIR
+    NX_List fairReadyList;      /* fair threads ready, unordered */
+    NX_Thread *fairReadyRoot;   /* heap of fair threads ready, smallest vruntime at root */
+    NX_U32 fairLoad;            /* weight sum of ready fair threads */
+    NX_U64 fairMinVruntime;     /* min vruntime on core, only grows */
+#endif
     NX_Thread *idleThread;  /* the idle thread on core */
     NX_ClockTick idleElapsedTicks;
     NX_U32 idleTime;
+    NX_ClockTick idleTicks;     /* ticks the core halted in idle */
+    NX_Bool halted;     /* core halted in idle, waiting for interrupt */
+    void *pageTable;    /* user page table loaded on core, NX_NULL for kernel page table */
+    void *tls;          /* user tls loaded on core */
 
     NX_Spin lock;     /* lock for CPU */
     NX_Atomic threadCount;    /* ready thread count on this core */
+    NX_U32 loadAvg;     /* decayed average of threads runnable on core, updated by sched tick */
+    NX_Bool online;     /* core had entered sched, threads can be placed on it */
+    NX_Atomic ipiPending;   /* pending ipi types sent to this core */
 };
 typedef struct NX_Cpu NX_Cpu;
 
 struct NX_SMP_Ops
 {
-    NX_UArch (*getIdx)(void);
+    void (*setCpuLocal)(void *cpu); /* bind per cpu data to current core */
     NX_Error (*bootApp)(NX_UArch bootCoreId);
     NX_Error (*enterApp)(NX_UArch appCoreId);
+    NX_Error (*sendIpi)(NX_UArch coreId);
+    void (*halt)(void);     /* called with interrupt disabled, halt until interrupt handled */
+    void (*cpuRelax)(void); /* hint core in spin wait loop */
 };
 
 NX_INTERFACE NX_IMPORT struct NX_SMP_Ops NX_SMP_OpsInterface; 
 
 #define NX_SMP_BootApp(bootCoreId)  NX_SMP_OpsInterface.bootApp(bootCoreId)
 #define NX_SMP_EnterApp(appCoreId)  NX_SMP_OpsInterface.enterApp(appCoreId)
-#define NX_SMP_GetIdx()             NX_SMP_OpsInterface.getIdx()
+#define NX_SMP_SetCpuLocal(cpu)     NX_SMP_OpsInterface.setCpuLocal(cpu)
+#define NX_SMP_Halt()               NX_SMP_OpsInterface.halt()
+#define NX_SMP_CpuRelax()           NX_SMP_OpsInterface.cpuRelax()
 
 void NX_SMP_Preload(NX_UArch coreId);
 void NX_SMP_Init(NX_UArch coreId);
@@ -57,23 +104,44 @@ void NX_SMP_DequeueThreadIrqDisabled(NX_UArch coreId, NX_Thread *thread);
 void NX_SMP_DequeueThread(NX_UArch coreId, NX_Thread *thread);
 
 NX_Thread *NX_SMP_PickThreadIrqDisabled(NX_UArch coreId);
+void NX_SMP_SetPriorityIrqDisabled(NX_Thread *thread, NX_U32 priority);
+void NX_SMP_SetAffinityIrqDisabled(NX_Thread *thread, NX_CpuMask mask);
+void NX_SMP_SwitchOutDone(NX_Thread *thread);
+void NX_SMP_MigrateOut(NX_UArch coreId, NX_Thread *thread);
 NX_Error NX_SMP_SetRunning(NX_UArch coreId, NX_Thread *thread);
 
 NX_Cpu *NX_CpuGetIndex(NX_UArch coreId);
 
-NX_Thread *NX_SMP_DeququeNoAffinityThread(NX_UArch coreId);
+NX_Thread *NX_SMP_DequeueAllowedThread(NX_UArch coreId, NX_UArch destCoreId);
+
+NX_UArch NX_SMP_FindBusiestCore(NX_UArch coreId);
+NX_UArch NX_SMP_FindIdlestCore(NX_CpuMask mask);
+NX_UArch NX_SMP_SelectWakeCore(NX_Thread *thread);
+void NX_SMP_UpdateLoad(NX_UArch coreId, NX_ClockTick ticks);
+
+NX_Error NX_SMP_SendIpi(NX_UArch coreId, NX_U32 ipi);
+void NX_SMP_IpiHandler(void);
+void NX_SMP_CallCores(NX_CpuMask mask, void (*func)(void *arg), void *arg);
+NX_CpuMask NX_SMP_TableLoadedCores(void *table);
+void NX_SMP_KickCore(NX_UArch coreId, NX_Thread *thread);
 
 /**
- * get CPU by core id
+ * get CPU of current core
  */
 NX_INLINE NX_Cpu *NX_CpuGetPtr(void)
 {
-    return NX_CpuGetIndex(NX_SMP_GetIdx());
+    return (NX_Cpu *)NX_HalCpuLocal();
 }
 
-NX_Thread *NX_SMP_GetRunning(void);
+/* load a member of current core cpu with one instruction, no irq save needed against migration */
+#define NX_CpuLocalLoad(member) NX_HalCpuLocalLoad(NX_OFFSET_OF_STRUCT(NX_Cpu, member))
+
+#define NX_SMP_GetIdx()             ((NX_UArch)NX_CpuLocalLoad(coreId))
+#define NX_SMP_GetRunning()         ((NX_Thread *)NX_CpuLocalLoad(threadRunning))
+
 NX_Error NX_SMP_SetIdle(NX_UArch coreId, NX_Thread *thread);
 NX_Thread * NX_SMP_GetIdle(NX_UArch coreId);
 NX_U32 NX_SMP_GetUsage(NX_UArch coreId);
+NX_U32 NX_SMP_GetIdleTime(NX_UArch coreId);
 
 #endif /* __SCHED_SMP__ */
@@ -17,17 +17,29 @@
 #include <base/atomic.h>
 
 #define NX_SPIN_MAGIC 0x10000001
-#define NX_SPIN_LOCK_VALUE 1
 
+/**
+ * ticket lock: take a ticket from next, wait until owner equal to ticket.
+ * thread get the lock in FIFO order.
+ */
 struct NX_Spin
 {
-    NX_Atomic value;
+    NX_Atomic next;     /* next ticket to take */
+    NX_Atomic owner;    /* ticket holding the lock */
+#ifdef CONFIG_NX_DEBUG
     NX_U32 magic;  /* magic for spin init */
+#endif
 };
 typedef struct NX_Spin NX_Spin;
 
-#define NX_SPIN_DEFINE_UNLOCKED(name) NX_Spin name = {NX_ATOMIC_INIT_VALUE(0), NX_SPIN_MAGIC}
-#define NX_SPIN_DEFINE_LOCKED(name) NX_Spin name = {NX_ATOMIC_INIT_VALUE(1), NX_SPIN_MAGIC}
+#ifdef CONFIG_NX_DEBUG
+#define NX_SPIN_INIT_VALUE(next) {NX_ATOMIC_INIT_VALUE(next), NX_ATOMIC_INIT_VALUE(0), NX_SPIN_MAGIC}
+#else
+#define NX_SPIN_INIT_VALUE(next) {NX_ATOMIC_INIT_VALUE(next), NX_ATOMIC_INIT_VALUE(0)}
+#endif
+
+#define NX_SPIN_DEFINE_UNLOCKED(name) NX_Spin name = NX_SPIN_INIT_VALUE(0)
+#define NX_SPIN_DEFINE_LOCKED(name) NX_Spin name = NX_SPIN_INIT_VALUE(1)
 
 NX_Error NX_SpinInit(NX_Spin *lock);
 NX_Error NX_SpinTryLock(NX_Spin *lock);
@@ -14,10 +14,15 @@
 
 #include <base/list.h>
 #include <base/timer.h>
+#include <base/hrtimer.h>
 #include <base/spin.h>
+#include <base/rwlock.h>
 #include <base/semaphore.h>
 #include <base/process.h>
 #include <base/vfs.h>
+#include <base/deadline.h>
+#include <base/fair.h>
+#include <base/cpumask.h>
 
 #ifdef CONFIG_NX_THREAD_NAME_LEN
 #define NX_THREAD_NAME_LEN CONFIG_NX_THREAD_NAME_LEN
@@ -31,6 +36,18 @@
 #define NX_THREAD_STACK_SIZE_DEFAULT 8192
 #endif
 
+#ifdef CONFIG_NX_THREAD_TIMESLICE
+#define NX_THREAD_TIMESLICE CONFIG_NX_THREAD_TIMESLICE
+#else
+#define NX_THREAD_TIMESLICE 3
+#endif
+
+#ifdef CONFIG_NX_THREAD_CACHE_NR
+#define NX_THREAD_CACHE_NR CONFIG_NX_THREAD_CACHE_NR
+#else
+#define NX_THREAD_CACHE_NR 8
+#endif
+
 /* time-sharing priority */
 #define NX_THREAD_PRIORITY_IDLE     0   /* idle thread priority */
 #define NX_THREAD_PRIORITY_LOW      1   /* low level priority */
@@ -65,7 +82,7 @@ struct NX_Hub;
 struct NX_HubChannel;
 struct NX_ThreadResource
 {
-    NX_Timer *sleepTimer;
+    NX_HrTimer *sleepTimer;
     NX_Process *process;
     NX_VfsFileTable *fileTable;
     struct NX_Hub *hub; /* hub for each thread */
@@ -86,6 +103,7 @@ struct NX_Thread
     NX_List exitList;
     NX_List processList;    /* list for process */
     NX_List blockList;    /* list for block on somewhere */
+    NX_List mutexList;    /* mutex owned and priority inherited from */
 
     NX_Spin lock;  /* lock for thread */
 
@@ -111,9 +129,24 @@ struct NX_Thread
     NX_U32 fixedPriority;  /* fixed priority, does not change dynamically  */
     NX_U32 priority;    /* dynamic priority, or in the case of time-sharing scheduling priority will change dynamically */
     NX_U32 needSched;
+    NX_U32 preemptCount;    /* preempt only when count is zero */
+    struct NX_Mutex *waitMutex; /* mutex blocked on, for priority inheritance chain */
     NX_U32 isTerminated;
     NX_UArch onCore;        /* thread on which core */
-    NX_UArch coreAffinity;  /* thread would like to run on the core */
+    NX_VOLATILE NX_U32 onCpu;   /* context in use on core, cleared after switched out */
+    NX_CpuMask coreAffinity;    /* cores thread allowed to run on */
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    NX_ThreadDeadline dl;   /* deadline class parameters and budget */
+#endif
+#ifdef CONFIG_NX_SCHED_FAIR
+    NX_U64 vruntime;        /* weighted run time in fair class */
+#endif
+#if defined(CONFIG_NX_SCHED_DEADLINE) || defined(CONFIG_NX_SCHED_FAIR)
+    /* ready heap node of deadline and fair class, prev is left sibling, or parent for first child */
+    struct NX_Thread *readyChild;
+    struct NX_Thread *readyNext;
+    struct NX_Thread *readyPrev;
+#endif
 
     /* thread resource */
     NX_ThreadResource resource;
@@ -124,13 +157,11 @@ struct NX_ThreadManager
 {
     NX_List globalList;    /* for global thread list */
     NX_List exitList;      /* for thread will exit soon */
-    NX_List pendingList;   /* for thread ready to be pulled by the core */
-    NX_Atomic averageThreadThreshold;    /* Average number of threads on core for load balance */
     NX_Atomic activeThreadCount;
-    NX_Atomic pendingThreadCount;
 
-    NX_Spin lock;    /* lock for thread manager */
+    NX_RwLock lock;    /* lock for global list, find and walk only read */
     NX_Spin exitLock;    /* lock for thread exit */
+    NX_Semaphore exitSem;   /* signal deamon when thread exit */
 };
 typedef struct NX_ThreadManager NX_ThreadManager;
 
@@ -142,6 +173,8 @@ typedef struct
     NX_U32 schedPriority;
 } NX_ThreadAttr;
 
+/* running thread on current core, read from per cpu data in one load */
+#define NX_ThreadSelf() NX_SMP_GetRunning()
 #define NX_CurrentThread NX_ThreadSelf()
 
 #define NX_ThreadSetFileTable(thread, fileTable) ((thread)->resource.fileTable = fileTable)
@@ -152,7 +185,6 @@ NX_Error NX_ThreadDestroy(NX_Thread *thread);
 
 NX_Error NX_ThreadTerminate(NX_Thread *thread, NX_U32 exitCode);
 void NX_ThreadExit(NX_U32 exitCode);
-NX_Thread *NX_ThreadSelf(void);
 NX_Thread *NX_ThreadFindById(NX_U32 tid);
 
 NX_Error NX_ThreadStart(NX_Thread *thread);
@@ -160,6 +192,7 @@ NX_Error NX_ThreadStartNotReady(NX_Thread *thread);
 
 void NX_ThreadYield(void);
 NX_Error NX_ThreadSetAffinity(NX_Thread *thread, NX_UArch coreId);
+NX_Error NX_ThreadSetAffinityMask(NX_Thread *thread, NX_CpuMask mask);
 
 NX_Error NX_ThreadBlock(NX_Thread *thread);
 NX_Error NX_ThreadBlockInterruptDisabled(NX_Thread *thread, NX_UArch irqLevel);
@@ -167,7 +200,8 @@ NX_Error NX_ThreadBlockLockedIRQ(NX_Thread *thread, NX_Spin *lock, NX_UArch irqL
 
 NX_Error NX_ThreadUnblock(NX_Thread *thread);
 
-NX_Error NX_ThreadSleep(NX_UArch microseconds);
+NX_Error NX_ThreadSleep(NX_UArch milliseconds);
+NX_Error NX_ThreadSleepNanosecond(NX_U64 nanoseconds);
 NX_Error NX_ThreadWait(NX_Thread * thread, NX_U32 *exitCode);
 
 NX_Error NX_ThreadWalk(NX_ThreadWalkHandler handler, void * arg);
@@ -180,10 +214,6 @@ void NX_SchedToFirstThread(void);
 void NX_ThreadEnququeExitList(NX_Thread *thread);
 NX_Thread *NX_ThreadDeququeExitList(void);
 
-void NX_ThreadEnqueuePendingList(NX_Thread *thread);
-void NX_ThreadDequeuePendingList(NX_Thread *thread);
-NX_Thread *NX_ThreadPickPendingList(void);
-
 void NX_ThreadReadyRunLocked(NX_Thread *thread, int flags);
 void NX_ThreadReadyRunUnlocked(NX_Thread *thread, int flags);
 
@@ -192,4 +222,7 @@ void NX_ThreadUnreadyRun(NX_Thread *thread);
 
 void NX_ThreadExitProcess(NX_Thread *thread, NX_Process *process);
 
+/* running thread read from cpu */
+#include <base/smp.h>
+
 #endif /* __SCHED_THREAD__ */
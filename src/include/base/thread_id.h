@@ -21,15 +21,24 @@
 #define NX_MAX_THREAD_NR 64
 #endif
 
+#define NX_THREAD_ID_WORDS NX_DIV_ROUND_UP(NX_MAX_THREAD_NR, 32)
+#define NX_THREAD_ID_FULL_WORDS NX_DIV_ROUND_UP(NX_THREAD_ID_WORDS, 32)
+
+struct NX_Thread;
+
 struct NX_ThreadID
 {
-    NX_U32 *maps;
+    NX_U32 maps[NX_THREAD_ID_WORDS];    /* bit set means id used */
+    NX_U32 fullMaps[NX_THREAD_ID_FULL_WORDS];   /* bit set means word in maps full */
+    struct NX_Thread *threads[NX_MAX_THREAD_NR];    /* thread bind on id */
     NX_U32 nextID;
     NX_Spin idLock;
 };
 
 int NX_ThreadIdAlloc(void);
 void NX_ThreadIdFree(int id);
+void NX_ThreadIdBind(int id, struct NX_Thread *thread);
+struct NX_Thread *NX_ThreadIdToThread(int id);
 void NX_ThreadsInitID(void);
 
 #endif /* __SCHED_THREAD_ID__ */
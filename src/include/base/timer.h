@@ -38,6 +38,8 @@ struct NX_Timer
     NX_TimerState state;   /* timer state */
     NX_ClockTick timeout;  /* timeout ticks */ 
     NX_ClockTick timeTicks;
+    int level;  /* timing wheel level timer waiting on */
+    NX_VOLATILE NX_UArch core;  /* core of timer base armed on */
     int flags;
     NX_Bool (*handler)(struct NX_Timer *, void *arg);
     void *arg;
@@ -59,6 +61,9 @@ NX_Error NX_TimerDestroy(NX_Timer *timer);
 void NX_TimerDump(NX_Timer *timer);
 
 void NX_TimersInit(void);
-void NX_TimerGo(void);
+void NX_TimerGo(NX_ClockTick ticks);
+NX_ClockTick NX_TimerNextTimeoutTicks(void);
+void NX_TimerMigrate(NX_UArch fromCore, NX_UArch toCore);
+void NX_TimerIdle(void);
 
 #endif  /* __MODS_TIME_TIMER__ */
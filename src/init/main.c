@@ -21,6 +21,7 @@
 #include <base/page_cache.h>
 #include <base/irq.h>
 #include <base/timer.h>
+#include <base/hrtimer.h>
 
 /**
  * see http://asciiarts.net
@@ -88,6 +89,9 @@ int NX_Main(NX_UArch coreId)
         /* init timer */
         NX_TimersInit();
 
+        /* init hrtimer */
+        NX_HrTimersInit();
+
         /* init multi core */
         NX_SMP_Init(coreId);
 
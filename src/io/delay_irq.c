@@ -11,6 +11,7 @@
 
 #include <base/delay_irq.h>
 #include <base/malloc.h>
+#include <base/preempt.h>
 
 /* protect flags */
 #define NX_IRQ_WORK_PENDING        0x80000000    /* work is pending */
@@ -174,13 +175,16 @@ NX_INTERFACE void NX_IRQ_DelayQueueCheck(void)
 {
     int checkTimes = NX_IRQ_DELAY_WORK_CHECK_TIMES;
     
+    /* works run with irq enabled, not preempt until interrupt return */
+    NX_PreemptDisable();
+
     while (checkTimes-- > 0)
     {
         NX_U32 irqEvent = IRQ_DelayEventGet();
         IRQ_DelayEventClear();
         if (irqEvent == 0)
         {
-            return;
+            break;
         }
         NX_IRQ_Enable();
 
@@ -201,4 +205,6 @@ NX_INTERFACE void NX_IRQ_DelayQueueCheck(void)
 
         NX_IRQ_Disable();
     }
+
+    NX_PreemptEnable();
 }
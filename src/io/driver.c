@@ -15,11 +15,12 @@
 #include <base/string.h>
 #include <base/memory.h>
 #include <base/debug.h>
+#include <base/rwlock.h>
 #define NX_LOG_NAME "driver"
 #include <base/log.h>
 
 NX_PRIVATE NX_LIST_HEAD(driverListHead);
-NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(driverLock);
+NX_PRIVATE NX_RWLOCK_DEFINE(driverLock); /* driver and device list read often */
 
 NX_Driver *NX_DriverCreate(const char *name, NX_DeviceType type, NX_U32 flags, NX_DriverOps *ops)
 {
@@ -68,18 +69,19 @@ NX_Error NX_DriverRegister(NX_Driver *driver)
         return NX_EINVAL;
     }
     NX_UArch level;
-    NX_SpinLockIRQ(&driverLock, &level);
+    NX_RwLockWriteIRQ(&driverLock, &level);
     
     NX_Driver *tmp;
     NX_ListForEachEntry(tmp, &driverListHead, list)
     {
         if (!NX_StrCmp(tmp->name, driver->name))
         {
+            NX_RwUnlockWriteIRQ(&driverLock, level);
             return NX_EAGAIN; /* meet same driver */
         }
     }
     NX_ListAdd(&driver->list, &driverListHead);
-    NX_SpinUnlockIRQ(&driverLock, level);
+    NX_RwUnlockWriteIRQ(&driverLock, level);
     return NX_EOK;
 }
 
@@ -91,9 +93,9 @@ NX_Error NX_DriverUnregister(NX_Driver *driver)
     }
 
     NX_UArch level;
-    NX_SpinLockIRQ(&driverLock, &level);
+    NX_RwLockWriteIRQ(&driverLock, &level);
     NX_ListDel(&driver->list);
-    NX_SpinUnlockIRQ(&driverLock, level);
+    NX_RwUnlockWriteIRQ(&driverLock, level);
     return NX_EOK;
 }
 
@@ -105,16 +107,16 @@ NX_Driver *NX_DriverSearch(const char *name)
     }
     NX_Driver *tmp;
     NX_UArch level;
-    NX_SpinLockIRQ(&driverLock, &level);
+    NX_RwLockReadIRQ(&driverLock, &level);
     NX_ListForEachEntry(tmp, &driverListHead, list)
     {
         if (!NX_StrCmp(tmp->name, name))
         {
-            NX_SpinUnlockIRQ(&driverLock, level);
+            NX_RwUnlockReadIRQ(&driverLock, level);
             return tmp;
         }
     }
-    NX_SpinUnlockIRQ(&driverLock, level);
+    NX_RwUnlockReadIRQ(&driverLock, level);
     return NX_NULL;
 }
 
@@ -283,20 +285,20 @@ NX_Device *NX_DeviceEnum(NX_Offset offset)
     NX_Offset idx;
 
     idx = 0;
-    NX_SpinLockIRQ(&driverLock, &level);
+    NX_RwLockReadIRQ(&driverLock, &level);
     NX_ListForEachEntry(driver, &driverListHead, list)
     {
         NX_ListForEachEntry(device, &driver->deviceListHead, list)
         {
             if (idx == offset)
             {
-                NX_SpinUnlockIRQ(&driverLock, level);
+                NX_RwUnlockReadIRQ(&driverLock, level);
                 return device;
             }
             idx++;
         }
     }
-    NX_SpinUnlockIRQ(&driverLock, level);
+    NX_RwUnlockReadIRQ(&driverLock, level);
     return NX_NULL;
 }
 
@@ -311,12 +313,12 @@ NX_Error NX_DeviceOpen(const char *name, NX_U32 flags, NX_Device **outDevice)
     NX_Driver *driver = NX_NULL;
     
     NX_UArch level;
-    NX_SpinLockIRQ(&driverLock, &level);
+    NX_RwLockReadIRQ(&driverLock, &level);
     device = NX_DeviceSearchLocked(name);
     if (device)
     {
         NX_AtomicInc(&device->reference);
-        NX_SpinUnlockIRQ(&driverLock, level);
+        NX_RwUnlockReadIRQ(&driverLock, level);
     
         driver = device->driver;
 
@@ -342,7 +344,7 @@ NX_Error NX_DeviceOpen(const char *name, NX_U32 flags, NX_Device **outDevice)
         }
         return NX_EOK;
     }
-    NX_SpinUnlockIRQ(&driverLock, level);
+    NX_RwUnlockReadIRQ(&driverLock, level);
     return NX_ENOSRCH;
 }
 
@@ -504,9 +506,9 @@ NX_Device *NX_DeviceSearch(const char *name)
 {
     NX_Device *device;
     NX_UArch level;
-    NX_SpinLockIRQ(&driverLock, &level);
+    NX_RwLockReadIRQ(&driverLock, &level);
     device = NX_DeviceSearchLocked(name);
-    NX_SpinUnlockIRQ(&driverLock, level);
+    NX_RwUnlockReadIRQ(&driverLock, level);
     return device;
 }
 
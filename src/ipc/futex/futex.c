@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: futex, wait on user address
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/futex.h>
+#include <base/thread.h>
+#include <base/process.h>
+#include <base/sched.h>
+#include <base/spin.h>
+#include <base/list.h>
+#include <base/irq.h>
+#include <base/uaccess.h>
+#include <base/initcall.h>
+
+typedef struct FutexBucket
+{
+    NX_Spin lock;
+    NX_List waitList;
+} FutexBucket;
+
+/* waiter live on stack of the blocked thread */
+typedef struct FutexWaiter
+{
+    NX_List list;
+    NX_Thread *thread;
+    void *space;    /* address space the addr belongs to */
+    NX_U32 *addr;
+} FutexWaiter;
+
+NX_PRIVATE FutexBucket futexTable[NX_FUTEX_HASH_NR];
+
+/**
+ * threads in the same process share the vmspace, kernel threads use NX_NULL
+ */
+NX_PRIVATE void *FutexSpace(void)
+{
+    NX_Process *process = NX_ProcessCurrent();
+    return process != NX_NULL ? (void *)&process->vmspace : NX_NULL;
+}
+
+NX_PRIVATE FutexBucket *FutexHash(void *space, NX_U32 *addr)
+{
+    NX_Addr key = ((NX_Addr)addr >> 2) ^ ((NX_Addr)space >> 4);
+    key ^= key >> 8;
+    return &futexTable[key & (NX_FUTEX_HASH_NR - 1)];
+}
+
+NX_Error NX_FutexWait(NX_U32 *addr, NX_U32 value)
+{
+    NX_Thread *self;
+    FutexBucket *bucket;
+    FutexWaiter waiter;
+    NX_U32 current;
+    NX_UArch level;
+    NX_Error err;
+
+    if (addr == NX_NULL || ((NX_Addr)addr & (sizeof(NX_U32) - 1)))
+    {
+        return NX_EINVAL;
+    }
+
+    self = NX_ThreadSelf();
+    waiter.thread = self;
+    waiter.space = FutexSpace();
+    waiter.addr = addr;
+    NX_ListInit(&waiter.list);
+
+    bucket = FutexHash(waiter.space, addr);
+
+    NX_SpinLockIRQ(&bucket->lock, &level);
+
+    /* check value with bucket locked, waker changed value before wake can not be missed */
+    if (NX_CopyFromUserEx(&current, addr) != NX_EOK)
+    {
+        NX_SpinUnlockIRQ(&bucket->lock, level);
+        return NX_EFAULT;
+    }
+
+    if (current != value)
+    {
+        NX_SpinUnlockIRQ(&bucket->lock, level);
+        return NX_EAGAIN;
+    }
+
+    NX_ListAddTail(&waiter.list, &bucket->waitList);
+    self->state = NX_THREAD_BLOCKED;
+    NX_SchedLockedIRQ(level, &bucket->lock);
+
+    /* still on list means not waked by futex, remove before stack gone */
+    err = NX_EOK;
+    NX_SpinLockIRQ(&bucket->lock, &level);
+    if (!NX_ListEmpty(&waiter.list))
+    {
+        NX_ListDelInit(&waiter.list);
+        err = NX_EINTR;
+    }
+    NX_SpinUnlockIRQ(&bucket->lock, level);
+
+    if (self->isTerminated != 0) /* check exit */
+    {
+        NX_ThreadExit(1);
+    }
+    return err;
+}
+
+NX_Error NX_FutexWake(NX_U32 *addr, NX_Size count, NX_Size *outWaked)
+{
+    FutexBucket *bucket;
+    FutexWaiter *waiter, *next;
+    void *space;
+    NX_Size waked;
+    NX_UArch level;
+
+    if (addr == NX_NULL || ((NX_Addr)addr & (sizeof(NX_U32) - 1)))
+    {
+        return NX_EINVAL;
+    }
+
+    space = FutexSpace();
+    bucket = FutexHash(space, addr);
+    waked = 0;
+
+    NX_SpinLockIRQ(&bucket->lock, &level);
+    NX_ListForEachEntrySafe(waiter, next, &bucket->waitList, list)
+    {
+        if (waked >= count)
+        {
+            break;
+        }
+        if (waiter->space == space && waiter->addr == addr)
+        {
+            /* waiter may return after unblock, do not touch it any more */
+            NX_ListDelInit(&waiter->list);
+            NX_ThreadUnblock(waiter->thread);
+            waked++;
+        }
+    }
+    NX_SpinUnlockIRQ(&bucket->lock, level);
+
+    if (outWaked != NX_NULL)
+    {
+        *outWaked = waked;
+    }
+    return NX_EOK;
+}
+
+NX_PRIVATE void NX_FutexInit(void)
+{
+    int i;
+    for (i = 0; i < NX_FUTEX_HASH_NR; i++)
+    {
+        NX_SpinInit(&futexTable[i].lock);
+        NX_ListInit(&futexTable[i].waitList);
+    }
+}
+
+NX_MODS_INIT(NX_FutexInit);
@@ -19,11 +19,12 @@
 #include <base/memory.h>
 #include <base/vmspace.h>
 #include <base/uaccess.h>
+#include <base/rwlock.h>
 
 #define NX_HUB_CLIENTS_MAX (-1UL)
 
 NX_PRIVATE NX_LIST_HEAD(hubSystemListHead);
-NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(hubSystemLock);
+NX_PRIVATE NX_RWLOCK_DEFINE(hubSystemLock);
 
 NX_PRIVATE void NX_HubReleaseMdl(NX_HubChannel *channel);
 
@@ -179,7 +180,7 @@ NX_PRIVATE NX_Hub *CreateHub(const char *name, NX_Size maxClient)
 	return hub;
 }
 
-NX_PRIVATE NX_Hub *SearchHub(const char *name)
+NX_PRIVATE NX_Hub *SearchHubLocked(const char *name)
 {
 	NX_Hub *hub;
 	NX_ListForEachEntry(hub, &hubSystemListHead, list)
@@ -192,6 +193,17 @@ NX_PRIVATE NX_Hub *SearchHub(const char *name)
 	return NX_NULL;
 }
 
+NX_PRIVATE NX_Hub *SearchHub(const char *name)
+{
+	NX_Hub *hub;
+	NX_UArch level;
+
+	NX_RwLockReadIRQ(&hubSystemLock, &level);
+	hub = SearchHubLocked(name);
+	NX_RwUnlockReadIRQ(&hubSystemLock, level);
+	return hub;
+}
+
 NX_PRIVATE NX_HubChannel *GetFreeChannel(NX_Hub *hub, NX_Thread *source)
 {
 	NX_HubChannel *channel;
@@ -267,9 +279,15 @@ NX_Error NX_HubRegister(const char *name, NX_Size maxClient, NX_Hub **outHub)
 		return NX_ENOMEM;
 	}
 
-	NX_SpinLockIRQ(&hubSystemLock, &level);
+	NX_RwLockWriteIRQ(&hubSystemLock, &level);
+	if (SearchHubLocked(name) != NX_NULL) /* registered by other thread */
+	{
+		NX_RwUnlockWriteIRQ(&hubSystemLock, level);
+		DestroyHub(hub);
+		return NX_EBUSY;
+	}
 	NX_ListAdd(&hub->list, &hubSystemListHead);
-	NX_SpinUnlockIRQ(&hubSystemLock, level);
+	NX_RwUnlockWriteIRQ(&hubSystemLock, level);
 
     self = NX_ThreadSelf();
 	self->resource.hub = hub;
@@ -313,9 +331,9 @@ NX_Error NX_HubUnregister(const char *name)
 
 	self->resource.hub = NX_NULL;
 
-	NX_SpinLockIRQ(&hubSystemLock, &level);
+	NX_RwLockWriteIRQ(&hubSystemLock, &level);
 	NX_ListDel(&hub->list);
-	NX_SpinUnlockIRQ(&hubSystemLock, level);
+	NX_RwUnlockWriteIRQ(&hubSystemLock, level);
 	
 	DestroyHub(hub);
 
@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: address space id allocator with generation rollover
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/asid.h>
+
+#ifdef CONFIG_NX_MMU_ASID
+
+#include <base/spin.h>
+#include <base/smp.h>
+#include <base/cpumask.h>
+#include <base/barrier.h>
+
+#define NX_LOG_NAME "asid"
+#include <base/log.h>
+
+#define ASID_NUMBER(asid) ((NX_UArch)((asid) & ((1ULL << asidBits) - 1)))
+#define ASID_GENERATION(asid) ((asid) >> asidBits)
+
+NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(asidLock);
+
+NX_PRIVATE NX_UArch asidBits;
+NX_PRIVATE NX_U64 asidGeneration;   /* generation in bits over asid number, never 0 */
+NX_PRIVATE NX_UArch asidNext;       /* next asid number in generation */
+
+/* cores must flush whole tlb on next switch */
+NX_PRIVATE NX_ATOMIC_DEFINE(asidFlushPending, 0)
+
+/**
+ * `bits` is asid width the hardware implemented, 0 means no asid
+ */
+void NX_AsidInit(NX_UArch bits)
+{
+    if (bits > NX_ASID_MAX_BITS)
+    {
+        bits = NX_ASID_MAX_BITS;
+    }
+    asidBits = bits;
+    asidGeneration = 1ULL << bits;
+    asidNext = NX_ASID_KERNEL + 1;
+    NX_LOG_I("%d asid bits", bits);
+}
+
+NX_UArch NX_AsidBits(void)
+{
+    return asidBits;
+}
+
+/**
+ * asid numbers used up, start a new generation, must hold asid lock
+ */
+NX_PRIVATE void AsidNewGeneration(void)
+{
+    asidGeneration += 1ULL << asidBits;
+    asidNext = NX_ASID_KERNEL + 1;
+
+    /* any core may cache entries of old asid numbers */
+    NX_AtomicSet(&asidFlushPending, NX_CPUMASK_ALL);
+}
+
+/**
+ * get asid to run `mmu` on current core, NX_NULL for kernel page table.
+ * allocate a new asid if the one it has is from old generation.
+ * `flush` returns tlb flush needed before run with the asid. called irq disabled.
+ */
+NX_UArch NX_AsidSwitch(NX_Mmu *mmu, int *flush)
+{
+    NX_CpuMask self = NX_CpuMaskCore(NX_SMP_GetIdx());
+    NX_U64 asid = NX_ASID_KERNEL;
+
+    *flush = NX_ASID_FLUSH_NONE;
+
+    if (mmu != NX_NULL)
+    {
+        asid = mmu->asid;
+        if (ASID_GENERATION(asid) != ASID_GENERATION(asidGeneration))
+        {
+            NX_SpinLock(&asidLock);
+            /* other thread of the space may allocated it on other core */
+            asid = mmu->asid;
+            if (ASID_GENERATION(asid) != ASID_GENERATION(asidGeneration))
+            {
+                if (asidNext >= (1UL << asidBits))
+                {
+                    AsidNewGeneration();
+                }
+                asid = asidGeneration | asidNext++;
+                mmu->asid = asid;
+                /* no core caches entries of new asid after it flushed for new generation */
+                NX_AtomicSet(&mmu->tlbStale, 0);
+            }
+            NX_SpinUnlock(&asidLock);
+        }
+        /* see flush pending set before the asid allocated in new generation */
+        NX_MemoryBarrierRead();
+
+        if (NX_AtomicGet(&mmu->tlbStale) & self)
+        {
+            NX_AtomicClearMask(&mmu->tlbStale, self);
+            *flush = NX_ASID_FLUSH_ASID;
+        }
+    }
+
+    if (NX_AtomicGet(&asidFlushPending) & self)
+    {
+        NX_AtomicClearMask(&asidFlushPending, self);
+        *flush = NX_ASID_FLUSH_ALL;
+    }
+
+    return ASID_NUMBER(asid);
+}
+
+/**
+ * asid number of `mmu`, NX_ASID_KERNEL if never switched to
+ */
+NX_UArch NX_AsidGet(NX_Mmu *mmu)
+{
+    return ASID_NUMBER(mmu->asid);
+}
+
+/**
+ * page unmapped from `mmu` (NX_NULL for kernel page table), current core flushed it,
+ * other cores may cache stale entries and flush them on next switch.
+ * called irq disabled.
+ */
+void NX_AsidMarkStale(NX_Mmu *mmu)
+{
+    NX_CpuMask others = NX_CPUMASK_ALL & ~NX_CpuMaskCore(NX_SMP_GetIdx());
+
+    if (mmu == NX_NULL)
+    {
+        NX_AtomicSetMask(&asidFlushPending, others);
+    }
+    else if (mmu->asid)
+    {
+        NX_AtomicSetMask(&mmu->tlbStale, others);
+    }
+}
+
+#endif /* CONFIG_NX_MMU_ASID */
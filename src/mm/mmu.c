@@ -20,4 +20,8 @@ void NX_MmuInit(NX_Mmu *mmu, void *pageTable, NX_Addr virStart, NX_Size size, NX
     mmu->virStart = virStart & NX_PAGE_ADDR_MASK;
     mmu->virEnd = virStart + NX_PAGE_ALIGNUP(size);
     mmu->earlyEnd = earlyEnd & NX_PAGE_ADDR_MASK;
+#ifdef CONFIG_NX_MMU_ASID
+    mmu->asid = 0;
+    NX_AtomicSet(&mmu->tlbStale, 0);
+#endif
 }
@@ -1,6 +1,7 @@
 #ifndef __NX_CONFIG__
 #define __NX_CONFIG__
 #define CONFIG_NX_CPU_64BITS 1
+#define CONFIG_NX_HAL_INLINE 1
 #define CONFIG_NX_DEBUG 1
 #define CONFIG_NX_LOG_LEVEL 3
 #define CONFIG_NX_DEBUG_COLOR 1
@@ -12,10 +13,13 @@
 #define CONFIG_NX_NR_IRQS 256
 #define CONFIG_NX_KVADDR_OFFSET 0x00000000
 #define CONFIG_NX_PAGE_SHIFT 12
+#define CONFIG_NX_ARCH_HAS_ASID 1
+#define CONFIG_NX_MMU_ASID 1
 #define CONFIG_NX_MAX_THREAD_NR 256
 #define CONFIG_NX_THREAD_NAME_LEN 32
 #define CONFIG_NX_THREAD_STACK_SIZE 8192
 #define CONFIG_NX_ENABLE_SCHED 1
+#define CONFIG_NX_PREEMPT 1
 #define CONFIG_NX_THREAD_MAX_PRIORITY_NR 16
 #define CONFIG_NX_PORCESS_ENV_ARGS 1024
 #define CONFIG_NX_TICKS_PER_SECOND 100
@@ -26,6 +26,7 @@
 #include <base/time.h>
 #include <base/malloc.h>
 #include <base/driver.h>
+#include <base/futex.h>
 
 #include "process_impl.h"
 
@@ -353,6 +354,15 @@ NX_PRIVATE NX_Error SysThreadSleep(NX_UArch microseconds)
     return NX_ThreadSleep(microseconds);
 }
 
+NX_PRIVATE NX_Error SysThreadNanoSleep(NX_UArch seconds, NX_UArch nanoseconds)
+{
+    if (nanoseconds >= NX_NANOSECOND_PER_SECOND)
+    {
+        return NX_EINVAL;
+    }
+    return NX_ThreadSleepNanosecond((NX_U64)seconds * NX_NANOSECOND_PER_SECOND + nanoseconds);
+}
+
 NX_PRIVATE NX_TimeVal SysClockGetMillisecond(void)
 {
     return NX_ClockTickGetMillisecond();
@@ -368,6 +378,20 @@ NX_PRIVATE NX_Error SysTimeGet(NX_Time * time)
     return NX_TimeGet(time);
 }
 
+/**
+ * deadline parameters from user are milliseconds, budget must be one tick at least
+ */
+NX_PRIVATE NX_Error ThreadSetDeadlineMillisecond(NX_Thread * thread, NX_U32 runtime, NX_U32 deadline, NX_U32 period)
+{
+    if (runtime && !NX_MillisecondToClockTick(runtime))
+    {
+        return NX_EINVAL;
+    }
+
+    return NX_ThreadSetDeadline(thread, NX_MillisecondToClockTick(runtime),
+        NX_MillisecondToClockTick(deadline), NX_MillisecondToClockTick(period));
+}
+
 NX_PRIVATE void UserThreadEntry(void * arg)
 {
     NX_Size userStackTop;
@@ -593,6 +617,52 @@ NX_PRIVATE NX_Error SysThreadTerminate(NX_Solt solt, NX_U32 exitCode)
     return NX_EOK;
 }
 
+NX_PRIVATE NX_Error SysThreadSetDeadline(NX_Solt solt, NX_U32 runtime, NX_U32 deadline, NX_U32 period)
+{
+    NX_ExposedObject * exobj;
+
+    if (solt == NX_SOLT_INVALID_VALUE)
+    {
+        return NX_EINVAL;
+    }
+
+    exobj = NX_ProcessGetSolt(NX_ProcessCurrent(), solt);
+    if (exobj == NX_NULL)
+    {
+        return NX_ENOSRCH;
+    }
+
+    if (exobj->type != NX_EXOBJ_THREAD)
+    {
+        return NX_ENORES;
+    }
+
+    return ThreadSetDeadlineMillisecond(exobj->object, runtime, deadline, period);
+}
+
+NX_PRIVATE NX_Error SysThreadSetAffinity(NX_Solt solt, NX_CpuMask mask)
+{
+    NX_ExposedObject * exobj;
+
+    if (solt == NX_SOLT_INVALID_VALUE)
+    {
+        return NX_EINVAL;
+    }
+
+    exobj = NX_ProcessGetSolt(NX_ProcessCurrent(), solt);
+    if (exobj == NX_NULL)
+    {
+        return NX_ENOSRCH;
+    }
+
+    if (exobj->type != NX_EXOBJ_THREAD)
+    {
+        return NX_ENORES;
+    }
+
+    return NX_ThreadSetAffinityMask(exobj->object, mask);
+}
+
 NX_PRIVATE NX_Error SysThreadGetId(NX_Solt solt, NX_U32 * outId)
 {
     NX_ExposedObject * exobj;
@@ -986,6 +1056,9 @@ NX_PRIVATE NX_Error MutexCloseSolt(void * object, NX_ExposedObjectType type)
 
 #define NX_MUTEX_ATTR_LOCKED 0x01
 
+/* attr bit[15~8]: priority ceiling, 0 means no ceiling */
+#define NX_MUTEX_ATTR_CEILING(attr) (((attr) >> 8) & 0xff)
+
 NX_PRIVATE NX_Error SysMutexCreate(NX_U32 attr, NX_Solt * outSolt)
 {
     NX_Mutex * mutex;
@@ -1021,6 +1094,12 @@ NX_PRIVATE NX_Error SysMutexCreate(NX_U32 attr, NX_Solt * outSolt)
         }
     }
 
+    if ((err = NX_MutexSetCeiling(mutex, NX_MUTEX_ATTR_CEILING(attr))) != NX_EOK)
+    {
+        NX_MemFree(mutex);
+        return err;
+    }
+
     process = NX_ProcessCurrent();
     if ((err = NX_ProcessInstallSolt(process, mutex, NX_EXOBJ_MUTEX, MutexCloseSolt, &solt)) != NX_EOK)
     {
@@ -1364,6 +1443,24 @@ NX_PRIVATE NX_Error SysDeviceControl(NX_Solt solt, NX_U32 cmd, void *arg)
     return NX_EOK;
 }
 
+NX_PRIVATE NX_Error SysFutexWait(NX_U32 *addr, NX_U32 value)
+{
+    return NX_FutexWait(addr, value);
+}
+
+NX_PRIVATE NX_Error SysFutexWake(NX_U32 *addr, NX_Size count, NX_Size *outWaked)
+{
+    NX_Size waked = 0;
+    NX_Error err;
+
+    err = NX_FutexWake(addr, count, &waked);
+    if (err == NX_EOK && outWaked != NX_NULL)
+    {
+        err = NX_CopyToUserEx(outWaked, &waked);
+    }
+    return err;
+}
+
 /* xbook env syscall table  */
 NX_PRIVATE const NX_SyscallHandler NX_SyscallTable[] = 
 {
@@ -1441,6 +1538,11 @@ NX_PRIVATE const NX_SyscallHandler NX_SyscallTable[] =
     SysDeviceRead,
     SysDeviceWrite,
     SysDeviceControl,
+    SysFutexWait,
+    SysFutexWake,           /* 75 */
+    SysThreadSetDeadline,
+    SysThreadSetAffinity,
+    SysThreadNanoSleep,
 };
 
 /* posix env syscall table */
@@ -0,0 +1,309 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: deadline scheduling class, EDF with CBS
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/deadline.h>
+#include <base/thread.h>
+#include <base/smp.h>
+#include <base/sched.h>
+#include <base/spin.h>
+#include <base/irq.h>
+
+#ifdef CONFIG_NX_SCHED_DEADLINE
+
+/* lock for bandwidth admitted on each core */
+NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(deadlineLock);
+
+/**
+ * start a new period from `now`
+ */
+NX_PRIVATE void DeadlineRefresh(NX_ThreadDeadline *dl, NX_ClockTick now)
+{
+    dl->absDeadline = now + dl->deadline;
+    dl->leftRuntime = dl->runtime;
+}
+
+/**
+ * replenish budget at next period and queue the thread back if it is parked.
+ * called in timer lock, so timer lock always taken before thread lock.
+ */
+NX_PRIVATE NX_Bool DeadlineReplenish(NX_Timer *timer, void *arg)
+{
+    NX_Thread *thread = (NX_Thread *)arg;
+    NX_ThreadDeadline *dl = &thread->dl;
+    NX_UArch level;
+
+    NX_SpinLockIRQ(&thread->lock, &level);
+    if (dl->throttled == NX_True)
+    {
+        dl->throttled = NX_False;
+        dl->absDeadline += dl->period;
+        dl->leftRuntime = dl->runtime;
+
+        /* ready but throttled thread is parked off the ready list */
+        if (thread->state == NX_THREAD_READY)
+        {
+            NX_SMP_EnqueueThreadIrqDisabled(thread->onCore, thread, NX_SCHED_TAIL);
+            NX_SMP_KickCore(thread->onCore, thread);
+        }
+    }
+    NX_SpinUnlockIRQ(&thread->lock, level);
+    return NX_True;
+}
+
+void NX_SchedDeadlineInit(NX_Thread *thread)
+{
+    thread->dl.runtime = 0;
+    thread->dl.deadline = 0;
+    thread->dl.period = 0;
+    thread->dl.absDeadline = 0;
+    thread->dl.leftRuntime = 0;
+    thread->dl.bandwidth = 0;
+    thread->dl.throttled = NX_False;
+    thread->dl.savedPriority = thread->fixedPriority;
+    thread->dl.savedAffinity = thread->coreAffinity;
+    thread->dl.core = NX_MULTI_CORES_NR;
+    NX_TimerInit(&thread->dl.timer, NX_TICKS_TO_MILLISECOND(1), DeadlineReplenish, thread, NX_TIMER_ONESHOT);
+}
+
+/**
+ * find a core in thread affinity can admit `bandwidth`, must hold deadline lock.
+ */
+NX_PRIVATE NX_UArch DeadlineAdmit(NX_CpuMask affinity, NX_U32 bandwidth)
+{
+    NX_UArch coreId;
+    NX_Cpu *cpu;
+
+    for (coreId = 0; coreId < NX_MULTI_CORES_NR; coreId++)
+    {
+        if (!NX_CpuMaskTest(affinity, coreId))
+        {
+            continue;
+        }
+        cpu = NX_CpuGetIndex(coreId);
+        if (cpu->online == NX_True && cpu->deadlineBandwidth + bandwidth <= NX_SCHED_DEADLINE_BANDWIDTH)
+        {
+            cpu->deadlineBandwidth += bandwidth;
+            return coreId;
+        }
+    }
+    return NX_MULTI_CORES_NR;
+}
+
+/**
+ * set deadline class parameters in clock ticks, runtime 0 turn thread back to priority class.
+ * thread is bound to the core admitted it. only current thread, or thread not started or
+ * blocked can be set, ready thread is on some ready list.
+ */
+NX_Error NX_ThreadSetDeadline(NX_Thread *thread, NX_ClockTick runtime, NX_ClockTick deadline, NX_ClockTick period)
+{
+    NX_U32 bandwidth = 0;
+    NX_UArch coreId = NX_MULTI_CORES_NR;
+    NX_UArch level;
+    NX_ThreadDeadline *dl;
+    NX_CpuMask affinity;
+    NX_Bool isSelf;
+
+    if (thread == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+
+    if (runtime)
+    {
+        if (!period || runtime > deadline || deadline > period)
+        {
+            return NX_EINVAL;
+        }
+        bandwidth = NX_DIV_ROUND_UP(runtime * 1000, period);
+    }
+
+    isSelf = (thread == NX_ThreadSelf()) ? NX_True : NX_False;
+    if (isSelf == NX_False && thread->state != NX_THREAD_INIT && thread->state != NX_THREAD_BLOCKED)
+    {
+        return NX_EBUSY;
+    }
+
+    dl = &thread->dl;
+
+    /* deadline thread is bound to admitted core, use the affinity before bound */
+    affinity = NX_ThreadIsDeadline(thread) ? dl->savedAffinity : thread->coreAffinity;
+
+    /* admission control: give back old bandwidth first, then find a core for new one */
+    NX_SpinLockIRQ(&deadlineLock, &level);
+    if (NX_ThreadIsDeadline(thread))
+    {
+        NX_CpuGetIndex(dl->core)->deadlineBandwidth -= dl->bandwidth;
+    }
+    if (runtime)
+    {
+        coreId = DeadlineAdmit(affinity, bandwidth);
+        if (coreId >= NX_MULTI_CORES_NR)
+        {
+            /* keep the old parameters */
+            if (NX_ThreadIsDeadline(thread))
+            {
+                NX_CpuGetIndex(dl->core)->deadlineBandwidth += dl->bandwidth;
+            }
+            NX_SpinUnlockIRQ(&deadlineLock, level);
+            return NX_ENORES;
+        }
+    }
+    NX_SpinUnlockIRQ(&deadlineLock, level);
+
+    /* timer handler take thread lock in timer lock, stop it out of thread lock */
+    NX_TimerStop(&dl->timer);
+
+    NX_SpinLockIRQ(&thread->lock, &level);
+    if (runtime)
+    {
+        if (!NX_ThreadIsDeadline(thread))
+        {
+            dl->savedPriority = thread->fixedPriority;
+            dl->savedAffinity = thread->coreAffinity;
+        }
+        dl->runtime = runtime;
+        dl->deadline = deadline;
+        dl->period = period;
+        dl->bandwidth = bandwidth;
+        dl->throttled = NX_False;
+        DeadlineRefresh(dl, NX_ClockTickGet());
+
+        dl->core = coreId;
+        /* thread still on cpu moves to the core when switched out */
+        NX_SMP_SetAffinityIrqDisabled(thread, NX_CpuMaskCore(coreId));
+        thread->fixedPriority = NX_THREAD_PRIORITY_RT_MAX;
+        thread->priority = NX_THREAD_PRIORITY_RT_MAX;
+    }
+    else if (NX_ThreadIsDeadline(thread))
+    {
+        dl->runtime = 0;
+        dl->throttled = NX_False;
+
+        thread->coreAffinity = dl->savedAffinity;
+        thread->fixedPriority = dl->savedPriority;
+        thread->priority = dl->savedPriority;
+    }
+    NX_SpinUnlockIRQ(&thread->lock, level);
+
+    /* current thread migrate to the admitted core */
+    if (isSelf == NX_True && runtime && coreId != NX_SMP_GetIdx())
+    {
+        NX_ThreadYield();
+    }
+    return NX_EOK;
+}
+
+/**
+ * leave deadline class and give back bandwidth when thread exit
+ */
+void NX_SchedDeadlineExit(NX_Thread *thread)
+{
+    NX_UArch level;
+
+    if (!NX_ThreadIsDeadline(thread))
+    {
+        return;
+    }
+
+    NX_TimerStop(&thread->dl.timer);
+
+    NX_SpinLockIRQ(&deadlineLock, &level);
+    NX_CpuGetIndex(thread->dl.core)->deadlineBandwidth -= thread->dl.bandwidth;
+    thread->dl.runtime = 0;
+    thread->dl.throttled = NX_False;
+    NX_SpinUnlockIRQ(&deadlineLock, level);
+}
+
+/**
+ * queue deadline thread on its core, called irq disabled.
+ * thread wakeup takes CBS rule, and throttled thread is parked until replenished.
+ */
+void NX_SchedDeadlineReadyRun(NX_Thread *thread, int flags)
+{
+    NX_ThreadDeadline *dl = &thread->dl;
+    NX_ClockTick now;
+
+    NX_SpinLock(&thread->lock);
+
+    if (thread->state != NX_THREAD_RUNNING && thread->state != NX_THREAD_READY && dl->throttled == NX_False)
+    {
+        /**
+         * keep current deadline and budget only when the budget left not exceed
+         * reserved bandwidth over the time left, else start a new period now.
+         */
+        now = NX_ClockTickGet();
+        if (!NX_DeadlineBefore(now, dl->absDeadline) ||
+            (NX_U64)dl->leftRuntime * dl->period > (NX_U64)(dl->absDeadline - now) * dl->runtime)
+        {
+            DeadlineRefresh(dl, now);
+        }
+    }
+
+    thread->state = NX_THREAD_READY;
+
+    if (thread->onCore >= NX_MULTI_CORES_NR) /* first ready, place on admitted core */
+    {
+        thread->onCore = dl->core;
+    }
+
+    if (dl->throttled == NX_False)
+    {
+        NX_SMP_EnqueueThreadIrqDisabled(thread->onCore, thread, flags);
+        NX_SMP_KickCore(thread->onCore, thread);
+    }
+
+    NX_SpinUnlock(&thread->lock);
+}
+
+/**
+ * charge running deadline thread, called by sched tick
+ */
+void NX_SchedDeadlineTick(NX_Thread *thread, NX_ClockTick ticks)
+{
+    NX_ThreadDeadline *dl = &thread->dl;
+    NX_ClockTick now, nextPeriod;
+    NX_ClockTick throttleTicks = 0;
+    NX_UArch level;
+
+    NX_SpinLockIRQ(&thread->lock, &level);
+
+    if (dl->throttled == NX_False)
+    {
+        dl->leftRuntime = dl->leftRuntime > ticks ? dl->leftRuntime - ticks : 0;
+        if (dl->leftRuntime == 0)
+        {
+            thread->needSched = 1;
+
+            now = NX_ClockTickGet();
+            nextPeriod = dl->absDeadline - dl->deadline + dl->period;
+            if (NX_DeadlineBefore(now, nextPeriod))
+            {
+                dl->throttled = NX_True;
+                throttleTicks = nextPeriod - now;
+            }
+            else /* overrun next period start, begin it now */
+            {
+                DeadlineRefresh(dl, now);
+            }
+        }
+    }
+
+    NX_SpinUnlockIRQ(&thread->lock, level);
+
+    /* timer start take timer lock, out of thread lock */
+    if (throttleTicks)
+    {
+        NX_TimerInit(&dl->timer, NX_TICKS_TO_MILLISECOND(throttleTicks), DeadlineReplenish, thread, NX_TIMER_ONESHOT);
+        NX_TimerStart(&dl->timer);
+    }
+}
+
+#endif /* CONFIG_NX_SCHED_DEADLINE */
@@ -17,6 +17,7 @@
 #include <base/log.h>
 
 NX_IMPORT NX_Error NX_ProcessDestroyObject(NX_Process *process);
+NX_IMPORT NX_ThreadManager gThreadManagerObject;
 
 /**
  * release resouce must for a thread run
@@ -52,7 +53,8 @@ NX_PRIVATE void DaemonThreadEntry(void *arg)
             }
         } while (thread != NX_NULL);
         
-        NX_ThreadSleep(500);
+        /* wait thread exit */
+        NX_SemaphoreWait(&gThreadManagerObject.exitSem);
     }
 }
 
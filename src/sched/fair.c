@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: fair scheduling class, weighted virtual runtime
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/fair.h>
+#include <base/thread.h>
+
+#ifdef CONFIG_NX_SCHED_FAIR
+
+/* each priority step is about 1.25 times cpu share of the lower one */
+NX_PRIVATE const NX_U32 fairWeightTable[NX_THREAD_PRIORITY_HIGH - NX_THREAD_PRIORITY_LOW + 1] = {
+    655, 820, 1024, 1280, 1600, 2000,
+};
+
+NX_PRIVATE NX_SchedFairTunables fairTunables = {
+    .latency = NX_SCHED_FAIR_LATENCY,
+    .minGranularity = NX_SCHED_FAIR_MIN_GRANULARITY,
+    .wakeupGranularity = NX_SCHED_FAIR_WAKEUP_GRANULARITY,
+};
+
+/**
+ * weight of priority, priority inherited over HIGH not in fair class
+ */
+NX_U32 NX_SchedFairWeight(NX_U32 priority)
+{
+    if (priority < NX_THREAD_PRIORITY_LOW)
+    {
+        priority = NX_THREAD_PRIORITY_LOW;
+    }
+    if (priority > NX_THREAD_PRIORITY_HIGH)
+    {
+        priority = NX_THREAD_PRIORITY_HIGH;
+    }
+    return fairWeightTable[priority - NX_THREAD_PRIORITY_LOW];
+}
+
+/**
+ * vruntime grows when run `ticks` at `weight`
+ */
+NX_U64 NX_SchedFairDelta(NX_ClockTick ticks, NX_U32 weight)
+{
+    return (NX_U32)(ticks * NX_SCHED_FAIR_VRUNTIME_SCALE * NX_SCHED_FAIR_WEIGHT_NORMAL) / weight;
+}
+
+/**
+ * timeslice is the share of latency by weight in core load, not less than min granularity.
+ * `load` is the weight sum of other fair threads ready on the core.
+ */
+NX_ClockTick NX_SchedFairSlice(NX_U32 weight, NX_U32 load)
+{
+    NX_ClockTick slice = fairTunables.latency * weight / (load + weight);
+
+    return slice < fairTunables.minGranularity ? fairTunables.minGranularity : slice;
+}
+
+/**
+ * thread woken after sleep placed half latency before min vruntime,
+ * so short sleeper runs soon, but long sleeper can not take the core for long.
+ */
+NX_U64 NX_SchedFairSleeperCredit(void)
+{
+    return NX_SchedFairDelta(fairTunables.latency, NX_SCHED_FAIR_WEIGHT_NORMAL) / 2;
+}
+
+NX_U64 NX_SchedFairWakeupLead(void)
+{
+    return NX_SchedFairDelta(fairTunables.wakeupGranularity, NX_SCHED_FAIR_WEIGHT_NORMAL);
+}
+
+/**
+ * charge running fair thread, called by sched tick
+ */
+void NX_SchedFairTick(NX_Thread *thread, NX_ClockTick ticks)
+{
+    thread->vruntime += NX_SchedFairDelta(ticks, NX_SchedFairWeight(thread->priority));
+}
+
+void NX_SchedFairGetTunables(NX_SchedFairTunables *tunables)
+{
+    *tunables = fairTunables;
+}
+
+NX_Error NX_SchedFairSetTunables(NX_SchedFairTunables *tunables)
+{
+    if (tunables == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+
+    if (!tunables->minGranularity || tunables->minGranularity > tunables->latency ||
+        tunables->wakeupGranularity > tunables->latency || tunables->latency > NX_SCHED_FAIR_MAX_LATENCY)
+    {
+        return NX_EINVAL;
+    }
+
+    /* readers take one field each time, no lock needed */
+    fairTunables = *tunables;
+    return NX_EOK;
+}
+
+#endif /* CONFIG_NX_SCHED_FAIR */
@@ -17,6 +17,7 @@
 #include <base/string.h>
 #include <base/timer.h>
 #include <base/smp.h>
+#include <base/irq.h>
 
 #define IDLE_TIME_S 1000 /* 1s */
 
@@ -26,8 +27,9 @@ NX_PRIVATE NX_Bool IdleTimer(NX_Timer *tm, void *arg)
     NX_Cpu *cpu = NX_CpuGetIndex(coreId);
     NX_TimeVal idleTime;
 
-    NX_ClockTick ticks = cpu->idleThread->elapsedTicks - cpu->idleElapsedTicks;
-    cpu->idleElapsedTicks = cpu->idleThread->elapsedTicks;
+    /* only count the ticks the core really halted */
+    NX_ClockTick ticks = cpu->idleTicks - cpu->idleElapsedTicks;
+    cpu->idleElapsedTicks = cpu->idleTicks;
     idleTime = NX_ClockTickToMillisecond(ticks);
     if (idleTime > IDLE_TIME_S)
     {
@@ -39,14 +41,36 @@ NX_PRIVATE NX_Bool IdleTimer(NX_Timer *tm, void *arg)
 
 /**
  * system idle thread on per cpu.
+ * halt the core when no thread ready, wakeup by interrupt or ipi.
  */
 NX_PRIVATE void IdleThreadEntry(void *arg)
 {
     NX_Thread *self = NX_ThreadSelf();
+    NX_Cpu *cpu = NX_CpuGetIndex(self->onCore);
+    NX_UArch level;
+
     NX_LOG_I("Idle thread: %s startting...", self->name);
     while (1)
     {
-        NX_ThreadYield();
+        level = NX_IRQ_SaveLevel();
+        /* check with interrupt disabled, avoid missing wakeup before halt */
+        if (NX_AtomicGet(&cpu->threadCount) == 0 && !self->needSched)
+        {
+            cpu->halted = NX_True;
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+            /* no periodic tick when idle, hand timers to busy core, sleep until next timer */
+            NX_TimerIdle();
+            NX_ClockEventUpdate();
+#endif
+            NX_SMP_Halt();
+            cpu->halted = NX_False;
+        }
+        NX_IRQ_RestoreLevel(level);
+
+        if (NX_AtomicGet(&cpu->threadCount) > 0)
+        {
+            NX_ThreadYield();
+        }
     }
 }
 
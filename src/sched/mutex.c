@@ -12,11 +12,19 @@
 #include <base/mutex.h>
 #include <base/sched.h>
 #include <base/thread.h>
+#include <base/smp.h>
 #include <base/irq.h>
+#include <base/debug.h>
 
 #define MUTEX_MAGIC 0x10000002
 
-NX_Error NX_MutexInit(NX_Mutex *mutex)
+/* max owners walked when pass inherited priority along blocking chain */
+#define MUTEX_INHERIT_DEPTH 8
+
+/* lock for priority inheritance: mutex wait list and owner list, thread wait mutex */
+NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(mutexInheritLock);
+
+NX_PRIVATE NX_Error MutexInit(NX_Mutex *mutex, NX_Bool locked)
 {
     if (mutex == NX_NULL)
     {
@@ -26,71 +34,330 @@ NX_Error NX_MutexInit(NX_Mutex *mutex)
     {
         return NX_EPERM;
     }
+    NX_ListInit(&mutex->waitList);
+    NX_ListInit(&mutex->ownerList);
+    mutex->ceiling = 0;
+    if (locked == NX_True)
+    {
+        NX_AtomicSet(&mutex->value, 1);
+        mutex->owner = NX_ThreadSelf();
+    }
+    else
+    {
+        NX_AtomicSet(&mutex->value, 0);
+        mutex->owner = NX_NULL;
+    }
     mutex->magic = MUTEX_MAGIC;
     return NX_EOK;
 }
 
+NX_Error NX_MutexInit(NX_Mutex *mutex)
+{
+    return MutexInit(mutex, NX_False);
+}
+
 NX_Error NX_MutexInitLocked(NX_Mutex *mutex)
 {
-    if (mutex == NX_NULL)
+    return MutexInit(mutex, NX_True);
+}
+
+/**
+ * highest priority thread can inherit from mutex it owned, must hold inherit lock
+ */
+NX_PRIVATE NX_U32 MutexInheritPriority(NX_Thread *thread)
+{
+    NX_Mutex *mutex;
+    NX_Thread *waiter;
+    NX_U32 priority = 0;
+
+    NX_ListForEachEntry(mutex, &thread->mutexList, ownerList)
     {
-        return NX_EINVAL;
+        if (mutex->ceiling > priority)
+        {
+            priority = mutex->ceiling;
+        }
+        NX_ListForEachEntry(waiter, &mutex->waitList, blockList)
+        {
+            if (waiter->priority > priority)
+            {
+                priority = waiter->priority;
+            }
+        }
     }
-    if (NX_SpinInit(&mutex->lock) != NX_EOK)
+    return priority;
+}
+
+/**
+ * boost or restore thread priority, then pass it to the owner of mutex thread blocked on.
+ * must hold inherit lock and irq disabled
+ */
+NX_PRIVATE void MutexUpdatePriority(NX_Thread *thread)
+{
+    NX_U32 priority;
+    int depth;
+
+    for (depth = 0; thread != NX_NULL && depth < MUTEX_INHERIT_DEPTH; depth++)
     {
-        return NX_EPERM;
+        priority = MutexInheritPriority(thread);
+        if (priority <= thread->fixedPriority)
+        {
+            if (thread->priority <= thread->fixedPriority) /* not boosted */
+            {
+                break;
+            }
+            priority = thread->fixedPriority; /* restore priority */
+        }
+
+        if (priority == thread->priority)
+        {
+            break;
+        }
+        NX_SMP_SetPriorityIrqDisabled(thread, priority);
+
+        thread = thread->waitMutex != NX_NULL ? thread->waitMutex->owner : NX_NULL;
     }
-    mutex->magic = MUTEX_MAGIC;
-    NX_SpinLock(&mutex->lock);
-    return NX_EOK;
+}
+
+/**
+ * owner inherit priority from mutex, must hold mutex lock and inherit lock
+ */
+NX_PRIVATE void MutexAttachOwner(NX_Mutex *mutex, NX_Thread *owner)
+{
+    if (owner != NX_NULL && NX_ListEmpty(&mutex->ownerList))
+    {
+        NX_ListAdd(&mutex->ownerList, &owner->mutexList);
+    }
+}
+
+NX_PRIVATE void MutexDetachOwner(NX_Mutex *mutex)
+{
+    if (!NX_ListEmpty(&mutex->ownerList))
+    {
+        NX_ListDelInit(&mutex->ownerList);
+    }
+}
+
+/**
+ * new owner got mutex, inherit from ceiling and left waiters. must hold mutex lock
+ */
+NX_PRIVATE void MutexOwnerInherit(NX_Mutex *mutex, NX_Thread *owner)
+{
+    if (mutex->ceiling == 0 && NX_ListEmpty(&mutex->waitList))
+    {
+        return;
+    }
+
+    NX_SpinLock(&mutexInheritLock);
+    MutexAttachOwner(mutex, owner);
+    MutexUpdatePriority(owner);
+    NX_SpinUnlock(&mutexInheritLock);
 }
 
 NX_Error NX_MutexTryLock(NX_Mutex *mutex)
 {
+    NX_UArch level;
+
     if (mutex == NX_NULL || mutex->magic != MUTEX_MAGIC)
     {
         return NX_EFAULT;
     }
 
-    /* disable interrupt for locking per cpu */
-    NX_UArch level = NX_IRQ_SaveLevel();
-    /* spin lock for mutex */
-    NX_Error err = NX_SpinTryLock(&mutex->lock);
-    NX_IRQ_RestoreLevel(level);
-    return err;
+    if (NX_AtomicCAS(&mutex->value, 0, 1) != 0)
+    {
+        return NX_ERROR;
+    }
+
+    /**
+     * waiter may enqueue before owner set and see no owner to boost,
+     * set owner and inherit from waiters in mutex lock.
+     */
+    NX_SpinLockIRQ(&mutex->lock, &level);
+    mutex->owner = NX_ThreadSelf();
+    MutexOwnerInherit(mutex, mutex->owner);
+    NX_SpinUnlockIRQ(&mutex->lock, level);
+    return NX_EOK;
+}
+
+/**
+ * owner is running on other core, only compare it with running thread of cores,
+ * owner may release mutex, exit and be freed while spinning, never touch it.
+ */
+NX_PRIVATE NX_Bool MutexOwnerRunning(NX_Thread *owner)
+{
+    NX_UArch coreId;
+    NX_UArch selfCoreId = NX_SMP_GetIdx();
+
+    for (coreId = 0; coreId < NX_MULTI_CORES_NR; coreId++)
+    {
+        if (coreId != selfCoreId && NX_CpuGetIndex(coreId)->threadRunning == owner)
+        {
+            return NX_True;
+        }
+    }
+    return NX_False;
+}
+
+/**
+ * owner running on other core will release mutex soon, spin is cheaper than sleep.
+ */
+NX_PRIVATE NX_Bool MutexSpinOnOwner(NX_Mutex *mutex, NX_Thread *owner)
+{
+    int count;
+
+    for (count = 0; count < NX_MUTEX_SPIN_COUNT; count++)
+    {
+        if (mutex->owner != owner || MutexOwnerRunning(owner) == NX_False)
+        {
+            break;
+        }
+        if (NX_AtomicGet(&mutex->value) == 0)
+        {
+            return NX_True;
+        }
+        NX_SMP_CpuRelax();
+    }
+    return NX_AtomicGet(&mutex->value) == 0 ? NX_True : NX_False;
 }
 
 NX_Error NX_MutexLock(NX_Mutex *mutex)
 {
+    NX_Thread *self;
+    NX_Thread *owner;
+    NX_UArch level;
+
     if (mutex == NX_NULL || mutex->magic != MUTEX_MAGIC)
     {
         return NX_EFAULT;
     }
 
-    do
+    /* fast path: mutex free */
+    if (NX_MutexTryLock(mutex) == NX_EOK)
     {
-        /* spin lock for mutex */
-        if (NX_MutexTryLock(mutex) == NX_EOK)
+        return NX_EOK;
+    }
+
+    self = NX_ThreadSelf();
+
+    while (1)
+    {
+        /* no thread context, only spin */
+        if (self == NX_NULL)
         {
+            if (NX_MutexTryLock(mutex) == NX_EOK)
+            {
+                break;
+            }
+            NX_SMP_CpuRelax();
+            continue;
+        }
+
+        owner = mutex->owner;
+        if (owner != NX_NULL && owner != self && MutexOwnerRunning(owner) == NX_True)
+        {
+            if (MutexSpinOnOwner(mutex, owner) == NX_True && NX_MutexTryLock(mutex) == NX_EOK)
+            {
+                break;
+            }
+        }
+
+        NX_SpinLockIRQ(&mutex->lock, &level);
+
+        /* mutex may released before got lock */
+        if (NX_AtomicCAS(&mutex->value, 0, 1) == 0)
+        {
+            mutex->owner = self;
+            MutexOwnerInherit(mutex, self);
+            NX_SpinUnlockIRQ(&mutex->lock, level);
             break;
         }
-        else
+
+        NX_SpinLock(&mutexInheritLock);
+        if (NX_ListEmptyCareful(&self->blockList))
+        {
+            NX_ListAddTail(&self->blockList, &mutex->waitList); /* add to list tail */
+        }
+        self->waitMutex = mutex;
+
+        /* owner inherit self priority, avoid middle priority threads run before it */
+        MutexAttachOwner(mutex, mutex->owner);
+        MutexUpdatePriority(mutex->owner);
+        NX_SpinUnlock(&mutexInheritLock);
+
+        NX_ASSERT(NX_ThreadBlockLockedIRQ(self, &mutex->lock, level) == NX_EOK); /* block self */
+
+        /* unlock handoff mutex to self directly */
+        if (mutex->owner == self)
         {
-            /* yield to other thread */
-            NX_ThreadYield();
+            break;
         }
-    } while (1);
+    }
 
     return NX_EOK;
 }
 
 NX_Error NX_MutexUnlock(NX_Mutex *mutex)
 {
+    NX_Thread *thread, *next, *owner;
+    NX_UArch level;
+
     if (mutex == NX_NULL || mutex->magic != MUTEX_MAGIC)
     {
         return NX_EFAULT;
     }
-    NX_SpinUnlock(&mutex->lock);
+
+    NX_SpinLockIRQ(&mutex->lock, &level);
+
+    /* no waiter and no inheritance, fast release */
+    if (NX_ListEmpty(&mutex->waitList) && NX_ListEmpty(&mutex->ownerList))
+    {
+        mutex->owner = NX_NULL;
+        NX_AtomicSet(&mutex->value, 0);
+        NX_SpinUnlockIRQ(&mutex->lock, level);
+        return NX_EOK;
+    }
+
+    NX_SpinLock(&mutexInheritLock);
+
+    /* pick first waiter, skip waiter will exit */
+    owner = NX_NULL;
+    NX_ListForEachEntrySafe(thread, next, &mutex->waitList, blockList)
+    {
+        NX_ListDelInit(&thread->blockList);
+        thread->waitMutex = NX_NULL;
+        if (thread->isTerminated == 0)
+        {
+            owner = thread;
+            break;
+        }
+    }
+
+    /* drop priority inherited from this mutex before wakeup new owner */
+    thread = mutex->owner;
+    MutexDetachOwner(mutex);
+    MutexUpdatePriority(thread);
+
+    if (owner != NX_NULL)
+    {
+        /* handoff to waiter, mutex keep locked */
+        mutex->owner = owner;
+        if (mutex->ceiling != 0 || !NX_ListEmpty(&mutex->waitList))
+        {
+            MutexAttachOwner(mutex, owner);
+            MutexUpdatePriority(owner);
+        }
+        NX_SpinUnlock(&mutexInheritLock);
+
+        NX_ThreadUnblock(owner);
+        NX_SpinUnlockIRQ(&mutex->lock, level);
+        return NX_EOK;
+    }
+
+    NX_SpinUnlock(&mutexInheritLock);
+
+    mutex->owner = NX_NULL;
+    NX_AtomicSet(&mutex->value, 0);
+
+    NX_SpinUnlockIRQ(&mutex->lock, level);
     return NX_EOK;
 }
 
@@ -100,5 +367,77 @@ NX_Error NX_MutexState(NX_Mutex *mutex)
     {
         return NX_EFAULT;
     }
-    return NX_SpinState(&mutex->lock);
+
+    if (NX_AtomicGet(&mutex->value) != 0)
+    {
+        return NX_EBUSY;
+    }
+    return NX_EOK;
+}
+
+/**
+ * set priority ceiling, owner run at least ceiling priority while holding mutex.
+ * 0 means no ceiling.
+ */
+NX_Error NX_MutexSetCeiling(NX_Mutex *mutex, NX_U32 ceiling)
+{
+    NX_UArch level;
+
+    if (mutex == NX_NULL || mutex->magic != MUTEX_MAGIC)
+    {
+        return NX_EFAULT;
+    }
+
+    if (ceiling >= NX_THREAD_MAX_PRIORITY_NR)
+    {
+        return NX_EINVAL;
+    }
+
+    NX_SpinLockIRQ(&mutex->lock, &level);
+    NX_SpinLock(&mutexInheritLock);
+
+    mutex->ceiling = ceiling;
+    if (NX_AtomicGet(&mutex->value) != 0 && mutex->owner != NX_NULL)
+    {
+        MutexAttachOwner(mutex, mutex->owner);
+        MutexUpdatePriority(mutex->owner);
+    }
+
+    NX_SpinUnlock(&mutexInheritLock);
+    NX_SpinUnlockIRQ(&mutex->lock, level);
+    return NX_EOK;
+}
+
+/**
+ * thread exit: leave the wait list of mutex blocked on, forget mutex owned.
+ * mutex owned keep locked.
+ */
+void NX_MutexThreadExit(NX_Thread *thread)
+{
+    NX_Mutex *mutex, *next;
+    NX_UArch level;
+
+    mutex = thread->waitMutex;
+    if (mutex != NX_NULL)
+    {
+        NX_SpinLockIRQ(&mutex->lock, &level);
+        NX_SpinLock(&mutexInheritLock);
+        if (thread->waitMutex == mutex) /* not handoff while locking */
+        {
+            NX_ListDelInit(&thread->blockList);
+            thread->waitMutex = NX_NULL;
+            MutexUpdatePriority(mutex->owner);
+        }
+        NX_SpinUnlock(&mutexInheritLock);
+        NX_SpinUnlockIRQ(&mutex->lock, level);
+    }
+
+    level = NX_IRQ_SaveLevel();
+    NX_SpinLock(&mutexInheritLock);
+    NX_ListForEachEntrySafe(mutex, next, &thread->mutexList, ownerList)
+    {
+        NX_ListDelInit(&mutex->ownerList);
+    }
+    NX_SpinUnlock(&mutexInheritLock);
+    NX_IRQ_RestoreLevel(level);
 }
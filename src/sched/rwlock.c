@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: reader-writer spin lock
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/rwlock.h>
+#include <base/irq.h>
+#include <base/smp.h>
+#include <base/preempt.h>
+#include <base/barrier.h>
+
+#ifdef CONFIG_NX_DEBUG
+#define RWLOCK_VALID(lock) ((lock) != NX_NULL && (lock)->magic == NX_RWLOCK_MAGIC)
+#else
+#define RWLOCK_VALID(lock) ((lock) != NX_NULL)
+#endif
+
+NX_Error NX_RwLockInit(NX_RwLock *lock)
+{
+    if (lock == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+#ifdef CONFIG_NX_DEBUG
+    if (lock->magic == NX_RWLOCK_MAGIC)
+    {
+        return NX_EFAULT;
+    }
+#endif
+
+    NX_AtomicSet(&lock->value, 0);
+    NX_AtomicSet(&lock->writerWaiting, 0);
+#ifdef CONFIG_NX_DEBUG
+    lock->magic = NX_RWLOCK_MAGIC;
+#endif
+    return NX_EOK;
+}
+
+NX_Error NX_RwLockTryRead(NX_RwLock *lock)
+{
+    NX_IArch value;
+
+    if (!RWLOCK_VALID(lock))
+    {
+        return NX_EFAULT;
+    }
+
+    if (NX_AtomicGet(&lock->writerWaiting) > 0)
+    {
+        return NX_ERROR;
+    }
+
+    NX_PreemptDisable();
+    value = NX_AtomicGet(&lock->value);
+    if (value >= 0 && NX_AtomicCAS(&lock->value, value, value + 1) == value)
+    {
+        return NX_EOK;
+    }
+    NX_PreemptEnable();
+    return NX_ERROR;
+}
+
+NX_Error NX_RwLockRead(NX_RwLock *lock)
+{
+    if (!RWLOCK_VALID(lock))
+    {
+        return NX_EFAULT;
+    }
+
+    while (NX_RwLockTryRead(lock) != NX_EOK)
+    {
+        NX_SMP_CpuRelax();
+    }
+    return NX_EOK;
+}
+
+NX_PRIVATE NX_Error RwReleaseRead(NX_RwLock *lock)
+{
+    if (!RWLOCK_VALID(lock))
+    {
+        return NX_EFAULT;
+    }
+
+    if (NX_AtomicGet(&lock->value) <= 0)
+    {
+        return NX_EPERM;
+    }
+
+    NX_AtomicDec(&lock->value);
+    return NX_EOK;
+}
+
+NX_Error NX_RwUnlockRead(NX_RwLock *lock)
+{
+    NX_Error err = RwReleaseRead(lock);
+    if (err == NX_EOK)
+    {
+        NX_PreemptEnable();
+    }
+    return err;
+}
+
+NX_Error NX_RwLockTryWrite(NX_RwLock *lock)
+{
+    if (!RWLOCK_VALID(lock))
+    {
+        return NX_EFAULT;
+    }
+
+    NX_PreemptDisable();
+    if (NX_AtomicCAS(&lock->value, 0, NX_RWLOCK_WRITER) == 0)
+    {
+        return NX_EOK;
+    }
+    NX_PreemptEnable();
+    return NX_ERROR;
+}
+
+NX_Error NX_RwLockWrite(NX_RwLock *lock)
+{
+    if (!RWLOCK_VALID(lock))
+    {
+        return NX_EFAULT;
+    }
+
+    NX_PreemptDisable();
+
+    /* stop new readers, wait old readers leave */
+    NX_AtomicInc(&lock->writerWaiting);
+    while (NX_AtomicCAS(&lock->value, 0, NX_RWLOCK_WRITER) != 0)
+    {
+        NX_SMP_CpuRelax();
+    }
+    NX_AtomicDec(&lock->writerWaiting);
+    return NX_EOK;
+}
+
+NX_PRIVATE NX_Error RwReleaseWrite(NX_RwLock *lock)
+{
+    if (!RWLOCK_VALID(lock))
+    {
+        return NX_EFAULT;
+    }
+
+    if (NX_AtomicGet(&lock->value) != NX_RWLOCK_WRITER)
+    {
+        return NX_EPERM;
+    }
+
+    /* writes in critical section visible before lock released */
+    NX_MemoryBarrier();
+    NX_AtomicSet(&lock->value, 0);
+    return NX_EOK;
+}
+
+NX_Error NX_RwUnlockWrite(NX_RwLock *lock)
+{
+    NX_Error err = RwReleaseWrite(lock);
+    if (err == NX_EOK)
+    {
+        NX_PreemptEnable();
+    }
+    return err;
+}
+
+NX_Error NX_RwLockReadIRQ(NX_RwLock *lock, NX_UArch *level)
+{
+    if (lock == NX_NULL || level == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+    *level = NX_IRQ_SaveLevel();
+    return NX_RwLockRead(lock);
+}
+
+NX_Error NX_RwUnlockReadIRQ(NX_RwLock *lock, NX_UArch level)
+{
+    if (lock == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+    if (RwReleaseRead(lock) != NX_EOK)
+    {
+        return NX_EFAULT;
+    }
+    NX_IRQ_RestoreLevel(level);
+    NX_PreemptEnable();
+    return NX_EOK;
+}
+
+NX_Error NX_RwLockWriteIRQ(NX_RwLock *lock, NX_UArch *level)
+{
+    if (lock == NX_NULL || level == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+    *level = NX_IRQ_SaveLevel();
+    return NX_RwLockWrite(lock);
+}
+
+NX_Error NX_RwUnlockWriteIRQ(NX_RwLock *lock, NX_UArch level)
+{
+    if (lock == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+    if (RwReleaseWrite(lock) != NX_EOK)
+    {
+        return NX_EFAULT;
+    }
+    NX_IRQ_RestoreLevel(level);
+    NX_PreemptEnable();
+    return NX_EOK;
+}
+
+NX_Error NX_RwLockState(NX_RwLock *lock)
+{
+    if (!RWLOCK_VALID(lock))
+    {
+        return NX_EFAULT;
+    }
+
+    if (NX_AtomicGet(&lock->value) != 0)
+    {
+        return NX_EBUSY;
+    }
+    return NX_EOK;
+}
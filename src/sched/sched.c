@@ -19,35 +19,51 @@
 #include <base/smp.h>
 #include <base/context.h>
 #include <base/process.h>
+#include <base/preempt.h>
+#include <base/page.h>
+#include <base/barrier.h>
+#include <base/clock.h>
 
-NX_IMPORT NX_ThreadManager gThreadManagerObject;
-NX_IMPORT NX_Atomic gActivedCoreCount;
-
+/**
+ * kernel thread runs lazily on the page table loaded, kernel space is mapped in all of them,
+ * threads of same process share page table, so page table only loaded when process changed,
+ * but switch to same one still takes tlb flush pending on this core for the space.
+ * loaded page table holds a page reference, not freed before core switched away from it,
+ * even its process exited.
+ */
 NX_INLINE void SchedSwithProcess(NX_Thread *thread)
 {
     NX_Process *process = thread->resource.process;
-    void *pageTable = NX_NULL;
+    NX_Cpu *cpu = NX_CpuGetPtr();
+    void *prevTable;
 
     if (process == NX_NULL)
     {
-        pageTable = NX_ProcessGetKernelPageTable();
+        return;
     }
-    else
+
+    prevTable = cpu->pageTable;
+    if (process->vmspace.mmu.table != prevTable)
     {
-        pageTable = process->vmspace.mmu.table;
+        /* set before loaded, core is seen by unmap on it, pair with barrier after pte cleared */
+        cpu->pageTable = process->vmspace.mmu.table;
+        NX_PageIncrease(NX_Virt2Phy(cpu->pageTable));
+        NX_MemoryBarrier();
     }
 
-    NX_ASSERT(pageTable != NX_NULL);
-    NX_ASSERT(NX_ProcessSwitchPageTable(pageTable) == NX_EOK);
-    
-    /* update tls */
-    if (thread->resource.tls)
+    /* arch skips loading same page table, only flushes tlb pending on this core */
+    NX_ASSERT(NX_ProcessSwitchPageTable(&process->vmspace) == NX_EOK);
+
+    if (prevTable != NX_NULL && prevTable != cpu->pageTable)
     {
-        NX_ProcessSetTls(thread->resource.tls);
+        NX_PageFree(NX_Virt2Phy(prevTable));
     }
-    else
+
+    /* kernel thread not use user tls */
+    if (thread->resource.tls != cpu->tls)
     {
-        NX_ProcessSetTls(NX_NULL);
+        NX_ProcessSetTls(thread->resource.tls);
+        cpu->tls = thread->resource.tls;
     }
 }
 
@@ -69,51 +85,72 @@ void NX_SchedToFirstThread(void)
     NX_Thread *thread = NX_SMP_PickThreadIrqDisabled(coreId);
     NX_ASSERT(thread != NX_NULL);
     NX_ASSERT(NX_SMP_SetRunning(coreId, thread) == NX_EOK);
+    thread->onCpu = 1;
     NX_LOG_D("Sched to first thread:%s/%d", thread->name, thread->tid);
     SchedToNext(thread);
     /* should never be here */
     NX_PANIC("Sched to first thread failed!");
 }
 
-NX_PRIVATE void PullOrPushThread(NX_UArch coreId)
+/**
+ * switch to current thread finished, context of the thread switched out is saved,
+ * clear its on cpu flag, then other cores can run or release it.
+ * exit thread is off its stack now, hand it to deamon to release.
+ * called by the thread switched to, irq may enabled by arch on the way.
+ */
+void NX_SchedFinishSwitch(void)
+{
+    NX_UArch level = NX_IRQ_SaveLevel();
+    NX_Cpu *cpu = NX_CpuGetPtr();
+    NX_Thread *prev = cpu->threadSwitchOut;
+    NX_Bool exited;
+
+    if (prev != NX_NULL)
+    {
+        cpu->threadSwitchOut = NX_NULL;
+        exited = prev->state == NX_THREAD_EXIT ? NX_True : NX_False;
+        /* context stores visible before flag cleared */
+        NX_MemoryBarrier();
+        NX_SMP_SwitchOutDone(prev);
+
+        if (exited == NX_True)
+        {
+            NX_ThreadEnququeExitList(prev);
+        }
+    }
+    NX_IRQ_RestoreLevel(level);
+}
+
+/**
+ * Work stealing: when this core has fewer ready threads than the busiest sibling,
+ * steal one thread allowed on this core from it. Only the victim core lock is taken.
+ */
+NX_PRIVATE void StealThread(NX_UArch coreId)
 {
     NX_Thread *thread;
-    NX_Cpu *cpu = NX_CpuGetIndex(coreId);
-    NX_IArch coreThreadCount = NX_AtomicGet(&cpu->threadCount);
+    NX_UArch busiestCore;
+    NX_IArch coreThreadCount = NX_AtomicGet(&NX_CpuGetIndex(coreId)->threadCount);
+
+    busiestCore = NX_SMP_FindBusiestCore(coreId);
+    if (busiestCore >= NX_MULTI_CORES_NR)
+    {
+        return;
+    }
 
     /**
-     * Adding 1 is to allow the processor core to do more pull operations instead of push operations.
-     * Can avoid the threads of the pending queue not running.
+     * Adding 1 is to avoid threads ping-pong between two cores when balanced.
      */
-    NX_UArch threadsPerCore = NX_AtomicGet(&gThreadManagerObject.activeThreadCount) / NX_AtomicGet(&gActivedCoreCount) + 1;
-
-    NX_LOG_D("core#%d: core threads:%d", coreId, coreThreadCount);
-    NX_LOG_D("core#%d: active threads:%d", coreId, NX_AtomicGet(&gThreadManagerObject.activeThreadCount));
-    NX_LOG_D("core#%d: pending threads:%d", coreId, NX_AtomicGet(&gThreadManagerObject.pendingThreadCount));
-    NX_LOG_D("core#%d: threads per core:%d", coreId, threadsPerCore);
-
-    if (coreThreadCount < threadsPerCore)
+    if (NX_AtomicGet(&NX_CpuGetIndex(busiestCore)->threadCount) <= coreThreadCount + 1)
     {
-        /* pull from pending */
-        thread = NX_ThreadPickPendingList();
-        if (thread != NX_NULL)
-        {
-            NX_LOG_D("---> core#%d: pull thread:%s/%d", coreId, thread->name, thread->tid);
-            thread->onCore = coreId;
-            NX_ThreadReadyRunLocked(thread, NX_SCHED_HEAD);
-        }
+        return;
     }
 
-    if (coreThreadCount > threadsPerCore)
+    thread = NX_SMP_DequeueAllowedThread(busiestCore, coreId);
+    if (thread != NX_NULL)
     {
-        /* push to pending */
-        thread = NX_SMP_DeququeNoAffinityThread(coreId);
-        if (thread != NX_NULL)
-        {
-            NX_LOG_D("---> core#%d: push thread:%s/%d", coreId, thread->name, thread->tid);
-            thread->onCore = NX_MULTI_CORES_NR;
-            NX_ThreadEnqueuePendingList(thread);
-        }
+        NX_LOG_D("---> core#%d: steal thread:%s/%d from core#%d", coreId, thread->name, thread->tid, busiestCore);
+        thread->onCore = coreId;
+        NX_ThreadReadyRunLocked(thread, NX_SCHED_HEAD | NX_SCHED_MIGRATED);
     }
 }
 
@@ -124,31 +161,53 @@ NX_PRIVATE void PullOrPushThread(NX_UArch coreId)
  */
 void NX_SchedLockedIRQ(NX_UArch irqLevel, NX_Spin *lock)
 {
-    NX_Thread *next, *prev;
+    NX_Thread *next, *prev, *cur;
     NX_UArch coreId = NX_SMP_GetIdx();
+    NX_Cpu *cpu = NX_CpuGetPtr();
+
+    /* interrupt came before last switch finished, finish it first */
+    NX_SchedFinishSwitch();
 
     /* put prev into list */
-    prev = NX_CurrentThread;
+    prev = cur = NX_CurrentThread;
 
     if (prev->state == NX_THREAD_EXIT)
     {
         prev = NX_NULL;    /* not save prev context */
     }
 
-    /* pull thread from pending list or push thread to pending list */
-    PullOrPushThread(coreId);
+    /* steal thread from busiest core */
+    StealThread(coreId);
 
     /* get next from local list */
     next = NX_SMP_PickThreadIrqDisabled(coreId);
     NX_ASSERT(next != NX_NULL);
-    NX_SMP_SetRunning(coreId, next);
 
-    /* unlock lock before sched */
+    /* unlock lock before sched, prev still running, so preempt count released on prev */
     if (lock)
     {
         NX_SpinUnlock(lock);
     }
 
+    NX_SMP_SetRunning(coreId, next);
+
+    /* exit thread still on its stack too, flag cleared by next after switched */
+    if (next != cur)
+    {
+        next->onCpu = 1;
+        cpu->threadSwitchOut = cur;
+
+        /* wakeup interrupt in halt switches idle away before it clears the flag */
+        if (cur == cpu->idleThread)
+        {
+            cpu->halted = NX_False;
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+            /* idle programmed clock event far away, next thread needs its timeslice tick */
+            NX_ClockEventUpdate();
+#endif
+        }
+    }
+
     if (prev != NX_NULL)
     {
         NX_ASSERT(prev && next);
@@ -159,6 +218,7 @@ void NX_SchedLockedIRQ(NX_UArch irqLevel, NX_Spin *lock)
     {
         SchedToNext(next);
     }
+    NX_SchedFinishSwitch();
     NX_IRQ_RestoreLevel(irqLevel);
 }
 
@@ -188,17 +248,91 @@ void NX_SchedExit(void)
     NX_Thread *cur = NX_CurrentThread;
     NX_LOG_D("Thread exit: %d", cur->tid);
 
+    /* queued to exit list by next thread after switched away */
     cur->state = NX_THREAD_EXIT;
-    NX_ThreadEnququeExitList(cur);
 
     NX_SchedInterruptDisabled(level);
 }
 
+/**
+ * put current thread to ready list tail and sched to others, called interrupt disabled
+ */
+NX_PRIVATE void SchedPreempt(NX_Thread *thread, NX_UArch level)
+{
+    thread->needSched = 0;
+
+    /* reset ticks from timeslice */
+    thread->ticks = thread->timeslice;
+
+    NX_ThreadReadyRunLocked(thread, NX_SCHED_TAIL);
+
+    NX_SchedInterruptDisabled(level);
+}
+
+#ifdef CONFIG_NX_PREEMPT
+void NX_PreemptDisable(void)
+{
+    NX_UArch level = NX_IRQ_SaveLevel();
+    NX_Thread *thread = NX_CpuGetPtr()->threadRunning;
+
+    if (thread != NX_NULL)
+    {
+        thread->preemptCount++;
+    }
+    NX_IRQ_RestoreLevel(level);
+}
+
+void NX_PreemptEnable(void)
+{
+    NX_Bool irqEnabled = NX_IRQ_IsEnabled();
+    NX_UArch level = NX_IRQ_SaveLevel();
+    NX_Thread *thread = NX_CpuGetPtr()->threadRunning;
+
+    if (thread != NX_NULL && thread->preemptCount > 0)
+    {
+        thread->preemptCount--;
+
+        /**
+         * take pending preempt, interrupt handler and irq disabled region
+         * will be checked on interrupt return or irq restore.
+         */
+        if (thread->preemptCount == 0 && thread->needSched && irqEnabled)
+        {
+            SchedPreempt(thread, level);
+            return;
+        }
+    }
+    NX_IRQ_RestoreLevel(level);
+}
+
+NX_U32 NX_PreemptCount(void)
+{
+    NX_U32 count = 0;
+    NX_UArch level = NX_IRQ_SaveLevel();
+    NX_Thread *thread = NX_CpuGetPtr()->threadRunning;
+
+    if (thread != NX_NULL)
+    {
+        count = thread->preemptCount;
+    }
+    NX_IRQ_RestoreLevel(level);
+    return count;
+}
+#endif
+
 void NX_ReSchedCheck(void)
 {
     NX_IRQ_Enable();
 
     NX_Thread *thread = NX_CurrentThread;
+
+    /* thread holding spin lock, preempt when it unlock */
+    if (thread->preemptCount > 0)
+    {
+        NX_IRQ_Disable();
+        return;
+    }
+
     if (thread->isTerminated)
     {
         NX_LOG_D("call terminate: %d", thread->tid);
@@ -207,15 +341,7 @@ void NX_ReSchedCheck(void)
     }
     if (thread->needSched)
     {
-        NX_UArch level = NX_IRQ_SaveLevel();
-        thread->needSched = 0;
-
-        /* reset ticks from timeslice */
-        thread->ticks = thread->timeslice;
-
-        NX_ThreadReadyRunUnlocked(thread, NX_SCHED_TAIL);
-
-        NX_SchedInterruptDisabled(level);
+        SchedPreempt(thread, NX_IRQ_SaveLevel());
     }
     NX_IRQ_Disable();
 }
@@ -13,6 +13,8 @@
 #include <base/thread.h>
 #include <base/sched.h>
 #include <base/irq.h>
+#include <base/bitops.h>
+#include <base/barrier.h>
 #define NX_LOG_NAME "smp"
 #define NX_LOG_LEVEL NX_LOG_INFO
 #include <base/log.h>
@@ -28,10 +30,31 @@ NX_PRIVATE NX_VOLATILE NX_UArch bootCoreId = 0;
 
 NX_PRIVATE NX_Cpu cpuArray[NX_MULTI_CORES_NR];
 
+/* one function call to other cores at a time, cores not done yet in wait mask */
+NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(callLock);
+NX_PRIVATE void (*callFunc)(void *arg);
+NX_PRIVATE void *callArg;
+NX_PRIVATE NX_ATOMIC_DEFINE(callWait, 0)
+
+/**
+ * bind cpu of `coreId` to current core, read by NX_CpuGetPtr, NX_SMP_GetIdx and NX_ThreadSelf
+ */
+NX_PRIVATE void SMP_BindCpu(NX_UArch coreId)
+{
+    NX_Cpu *cpu = &cpuArray[coreId];
+
+    cpu->self = cpu;
+    cpu->coreId = coreId;
+    NX_SMP_SetCpuLocal(cpu);
+}
+
 void NX_SMP_Preload(NX_UArch coreId)
 {
     /* recored boot core */
     bootCoreId = coreId;
+
+    /* per cpu data used before anything else */
+    SMP_BindCpu(coreId);
 }
 
 NX_UArch NX_SMP_GetBootCore(void)
@@ -48,17 +71,45 @@ void NX_SMP_Init(NX_UArch coreId)
     int i, j;
     for (i = 0; i < NX_MULTI_CORES_NR; i++)
     {
+        cpuArray[i].self = &cpuArray[i];
+        cpuArray[i].coreId = i;
         cpuArray[i].threadRunning = NX_NULL;
+        cpuArray[i].threadSwitchOut = NX_NULL;
         cpuArray[i].idleThread = NX_NULL;
         cpuArray[i].idleElapsedTicks = 0;
         cpuArray[i].idleTime = 0;
+        cpuArray[i].idleTicks = 0;
+        cpuArray[i].halted = NX_False;
+        cpuArray[i].pageTable = NX_NULL;
+        cpuArray[i].tls = NX_NULL;
         for (j = 0; j < NX_THREAD_MAX_PRIORITY_NR; j++)
         {
             NX_ListInit(&cpuArray[i].threadReadyList[j]);
         }
+        cpuArray[i].readyPriorityGroup = 0;
+        for (j = 0; j < NX_PRIORITY_BITMAP_WORDS; j++)
+        {
+            cpuArray[i].readyPriorityMap[j] = 0;
+        }
+#ifdef CONFIG_NX_SCHED_DEADLINE
+        NX_ListInit(&cpuArray[i].deadlineReadyList);
+        cpuArray[i].deadlineReadyRoot = NX_NULL;
+        cpuArray[i].deadlineBandwidth = 0;
+#endif
+#ifdef CONFIG_NX_SCHED_FAIR
+        NX_ListInit(&cpuArray[i].fairReadyList);
+        cpuArray[i].fairReadyRoot = NX_NULL;
+        cpuArray[i].fairLoad = 0;
+        cpuArray[i].fairMinVruntime = 0;
+#endif
         NX_SpinInit(&cpuArray[i].lock);
         NX_AtomicSet(&cpuArray[i].threadCount, 0);
+        cpuArray[i].loadAvg = 0;
+        cpuArray[i].online = NX_False;
+        NX_AtomicSet(&cpuArray[i].ipiPending, 0);
     }
+    /* boot core always online */
+    cpuArray[coreId].online = NX_True;
 }
 
 /**
@@ -86,6 +137,9 @@ void NX_SMP_Main(NX_UArch coreId)
 void NX_SMP_Stage2(NX_UArch appCoreId)
 {
     NX_Error err;
+
+    SMP_BindCpu(appCoreId);
+
     err = NX_SMP_EnterApp(appCoreId);
     if (err != NX_EOK)
     {
@@ -99,28 +153,272 @@ void NX_SMP_Stage2(NX_UArch appCoreId)
         }
         else
         {
+            NX_CpuGetIndex(appCoreId)->online = NX_True;
             NX_LOG_I("app core: %d setup success!", appCoreId);    
         }
     }
 }
 
-void NX_SMP_EnqueueThreadIrqDisabled(NX_UArch coreId, NX_Thread *thread, int flags)
+#if defined(CONFIG_NX_SCHED_DEADLINE) || defined(CONFIG_NX_SCHED_FAIR)
+/**
+ * deadline and fair threads ready are ordered in a pairing heap of each core,
+ * the one runs first is at root, so enqueue is O(1) and dequeue O(log n) amortized
+ * under cpu lock. threads are also on ready list of the class for walking them.
+ */
+typedef NX_Bool (*ReadyHeapBefore)(NX_Thread *a, NX_Thread *b);
+
+/**
+ * meld two heaps, the later root becomes first child of the earlier one, `a` wins ties
+ */
+NX_PRIVATE NX_Thread *ReadyHeapMeld(NX_Thread *a, NX_Thread *b, ReadyHeapBefore before)
 {
-    NX_ASSERT(thread->priority >= 0 && thread->priority < NX_THREAD_MAX_PRIORITY_NR);
+    NX_Thread *tmp;
 
-    NX_Cpu *cpu = NX_CpuGetIndex(coreId);
+    if (a == NX_NULL)
+    {
+        return b;
+    }
+    if (b == NX_NULL)
+    {
+        return a;
+    }
+    if (before(b, a) == NX_True)
+    {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
 
-    NX_SpinLock(&cpu->lock);
+    b->readyPrev = a;
+    b->readyNext = a->readyChild;
+    if (a->readyChild != NX_NULL)
+    {
+        a->readyChild->readyPrev = b;
+    }
+    a->readyChild = b;
+    return a;
+}
+
+/**
+ * meld sibling list into one heap: meld pairs from left, then meld the pairs from right
+ */
+NX_PRIVATE NX_Thread *ReadyHeapMergePairs(NX_Thread *first, ReadyHeapBefore before)
+{
+    NX_Thread *pairs = NX_NULL;
+    NX_Thread *heap = NX_NULL;
+    NX_Thread *a;
+    NX_Thread *b;
+
+    while (first != NX_NULL)
+    {
+        a = first;
+        b = a->readyNext;
+        first = (b != NX_NULL) ? b->readyNext : NX_NULL;
+
+        a->readyNext = a->readyPrev = NX_NULL;
+        if (b != NX_NULL)
+        {
+            b->readyNext = b->readyPrev = NX_NULL;
+        }
+
+        /* push melded pair, list in reverse order */
+        a = ReadyHeapMeld(a, b, before);
+        a->readyNext = pairs;
+        pairs = a;
+    }
+
+    while (pairs != NX_NULL)
+    {
+        a = pairs;
+        pairs = a->readyNext;
+        a->readyNext = NX_NULL;
+        heap = ReadyHeapMeld(heap, a, before);
+    }
+    return heap;
+}
+
+NX_PRIVATE void ReadyHeapDel(NX_Thread **root, NX_Thread *thread, ReadyHeapBefore before)
+{
+    if (thread == *root)
+    {
+        *root = ReadyHeapMergePairs(thread->readyChild, before);
+    }
+    else
+    {
+        /* cut subtree from its siblings, then meld it back without its root */
+        if (thread->readyPrev->readyChild == thread)
+        {
+            thread->readyPrev->readyChild = thread->readyNext;
+        }
+        else
+        {
+            thread->readyPrev->readyNext = thread->readyNext;
+        }
+        if (thread->readyNext != NX_NULL)
+        {
+            thread->readyNext->readyPrev = thread->readyPrev;
+        }
+        *root = ReadyHeapMeld(*root, ReadyHeapMergePairs(thread->readyChild, before), before);
+    }
+
+    thread->readyChild = NX_NULL;
+    thread->readyNext = NX_NULL;
+    thread->readyPrev = NX_NULL;
+}
+#endif
+
+#ifdef CONFIG_NX_SCHED_DEADLINE
+NX_PRIVATE NX_Bool DeadlineBefore(NX_Thread *a, NX_Thread *b)
+{
+    return (NX_IArch)(a->dl.absDeadline - b->dl.absDeadline) < 0 ? NX_True : NX_False;
+}
 
+/**
+ * queue deadline thread by absolute deadline, head flag put it before equal deadline at root
+ */
+NX_PRIVATE void CpuDeadlineListAdd(NX_Cpu *cpu, NX_Thread *thread, int flags)
+{
+    NX_ListAddTail(&thread->list, &cpu->deadlineReadyList);
     if (flags & NX_SCHED_HEAD)
     {
-        NX_ListAdd(&thread->list, &cpu->threadReadyList[thread->priority]);
+        cpu->deadlineReadyRoot = ReadyHeapMeld(thread, cpu->deadlineReadyRoot, DeadlineBefore);
     }
     else
     {
-        NX_ListAddTail(&thread->list, &cpu->threadReadyList[thread->priority]);
+        cpu->deadlineReadyRoot = ReadyHeapMeld(cpu->deadlineReadyRoot, thread, DeadlineBefore);
+    }
+}
+#endif
+
+#ifdef CONFIG_NX_SCHED_FAIR
+NX_PRIVATE NX_Bool FairBefore(NX_Thread *a, NX_Thread *b)
+{
+    return a->vruntime < b->vruntime ? NX_True : NX_False;
+}
+
+/**
+ * queue fair thread by vruntime. thread woken or migrated is placed no earlier than
+ * the min vruntime minus sleeper credit, so it can not starve threads on this core.
+ * migrated thread brings lag to min vruntime of its old core, based on this core.
+ */
+NX_PRIVATE void CpuFairListAdd(NX_Cpu *cpu, NX_Thread *thread, int flags)
+{
+    NX_U64 credit = NX_SchedFairSleeperCredit();
+    NX_I64 lag;
+
+    if (flags & NX_SCHED_MIGRATED)
+    {
+        lag = (NX_I64)thread->vruntime;
+        thread->vruntime = (lag < 0 && (NX_U64)-lag > cpu->fairMinVruntime) ? 0 : cpu->fairMinVruntime + lag;
     }
 
+    if (cpu->fairMinVruntime > credit && thread->vruntime < cpu->fairMinVruntime - credit)
+    {
+        thread->vruntime = cpu->fairMinVruntime - credit;
+    }
+
+    NX_ListAddTail(&thread->list, &cpu->fairReadyList);
+    cpu->fairReadyRoot = ReadyHeapMeld(cpu->fairReadyRoot, thread, FairBefore);
+
+    cpu->fairLoad += NX_SchedFairWeight(thread->priority);
+}
+#endif
+
+/**
+ * add thread to ready list and mark priority ready, must hold cpu lock
+ */
+NX_PRIVATE void CpuReadyListAdd(NX_Cpu *cpu, NX_Thread *thread, int flags)
+{
+    NX_U32 prio = thread->priority;
+
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    if (NX_ThreadIsDeadline(thread))
+    {
+        CpuDeadlineListAdd(cpu, thread, flags);
+        return;
+    }
+#endif
+#ifdef CONFIG_NX_SCHED_FAIR
+    if (NX_ThreadIsFair(thread))
+    {
+        CpuFairListAdd(cpu, thread, flags);
+        return;
+    }
+#endif
+
+    if (flags & NX_SCHED_HEAD)
+    {
+        NX_ListAdd(&thread->list, &cpu->threadReadyList[prio]);
+    }
+    else
+    {
+        NX_ListAddTail(&thread->list, &cpu->threadReadyList[prio]);
+    }
+
+    cpu->readyPriorityMap[prio / 32] |= (1U << (prio % 32));
+    cpu->readyPriorityGroup |= (1U << (prio / 32));
+}
+
+/**
+ * del thread from ready list and clear priority if list empty, must hold cpu lock
+ */
+NX_PRIVATE void CpuReadyListDel(NX_Cpu *cpu, NX_Thread *thread)
+{
+    NX_U32 prio = thread->priority;
+
+    NX_ListDelInit(&thread->list);
+
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    if (NX_ThreadIsDeadline(thread))
+    {
+        ReadyHeapDel(&cpu->deadlineReadyRoot, thread, DeadlineBefore);
+        return;
+    }
+#endif
+#ifdef CONFIG_NX_SCHED_FAIR
+    if (NX_ThreadIsFair(thread))
+    {
+        ReadyHeapDel(&cpu->fairReadyRoot, thread, FairBefore);
+        cpu->fairLoad -= NX_SchedFairWeight(prio);
+        return;
+    }
+#endif
+
+    if (NX_ListEmpty(&cpu->threadReadyList[prio]))
+    {
+        cpu->readyPriorityMap[prio / 32] &= ~(1U << (prio % 32));
+        if (!cpu->readyPriorityMap[prio / 32])
+        {
+            cpu->readyPriorityGroup &= ~(1U << (prio / 32));
+        }
+    }
+}
+
+/**
+ * get highest ready priority, -1 means no thread ready, must hold cpu lock
+ */
+NX_PRIVATE int CpuReadyHighestPriority(NX_Cpu *cpu)
+{
+    int group;
+
+    if (!cpu->readyPriorityGroup)
+    {
+        return -1;
+    }
+    group = NX_FLS(cpu->readyPriorityGroup) - 1;
+    return group * 32 + NX_FLS(cpu->readyPriorityMap[group]) - 1;
+}
+
+void NX_SMP_EnqueueThreadIrqDisabled(NX_UArch coreId, NX_Thread *thread, int flags)
+{
+    NX_ASSERT(thread->priority >= 0 && thread->priority < NX_THREAD_MAX_PRIORITY_NR);
+
+    NX_Cpu *cpu = NX_CpuGetIndex(coreId);
+
+    NX_SpinLock(&cpu->lock);
+
+    CpuReadyListAdd(cpu, thread, flags);
+
     NX_AtomicInc(&cpu->threadCount);
 
     NX_SpinUnlock(&cpu->lock);
@@ -134,7 +432,7 @@ void NX_SMP_DequeueThreadIrqDisabled(NX_UArch coreId, NX_Thread *thread)
 
     NX_SpinLock(&cpu->lock);
 
-    NX_ListDel(&thread->list);
+    CpuReadyListDel(cpu, thread);
     NX_AtomicDec(&cpu->threadCount);
 
     NX_SpinUnlock(&cpu->lock);
@@ -150,11 +448,18 @@ void NX_SMP_DequeueThread(NX_UArch coreId, NX_Thread *thread)
     NX_IRQ_RestoreLevel(level);
 }
 
+#ifndef CONFIG_NX_SCHED_FAIR
 /**
  * This is based on a multi-level feedback queue scheduling algorithm to do the calculations.
  */
 NX_PRIVATE void NX_ThreadLowerPriority(NX_Thread *thread)
 {
+    /* priority inherited from mutex waiters, keep it until mutex released */
+    if (thread->priority > thread->fixedPriority)
+    {
+        return;
+    }
+
     /* Time-sharing scheduling requires lowering the priority of threads */
     if (thread->fixedPriority >= NX_THREAD_PRIORITY_LOW && thread->fixedPriority <= NX_THREAD_PRIORITY_HIGH)
     {
@@ -165,6 +470,144 @@ NX_PRIVATE void NX_ThreadLowerPriority(NX_Thread *thread)
         }
     }
 }
+#endif
+
+/**
+ * change thread priority, requeue it if on ready list. must called irq disabled
+ */
+void NX_SMP_SetPriorityIrqDisabled(NX_Thread *thread, NX_U32 priority)
+{
+    NX_UArch coreId;
+    NX_Cpu *cpu;
+
+    NX_ASSERT(priority < NX_THREAD_MAX_PRIORITY_NR);
+
+    while (1)
+    {
+        coreId = thread->onCore;
+        if (coreId >= NX_MULTI_CORES_NR) /* not on any core */
+        {
+            thread->priority = priority;
+            return;
+        }
+
+        cpu = NX_CpuGetIndex(coreId);
+        NX_SpinLock(&cpu->lock);
+        if (thread->onCore == coreId) /* not migrated while locking */
+        {
+            break;
+        }
+        NX_SpinUnlock(&cpu->lock);
+    }
+
+    if (!NX_ListEmpty(&thread->list)) /* on ready list */
+    {
+        CpuReadyListDel(cpu, thread);
+        thread->priority = priority;
+        CpuReadyListAdd(cpu, thread, NX_SCHED_TAIL);
+        NX_SpinUnlock(&cpu->lock);
+
+        NX_SMP_KickCore(coreId, thread);
+    }
+    else
+    {
+        thread->priority = priority;
+        NX_SpinUnlock(&cpu->lock);
+    }
+}
+
+/**
+ * change cores thread allowed to run on, move it to an allowed core if its core
+ * not allowed any more. thread still on cpu keeps its core, migration is pending
+ * until it switched out or enqueued next time. must called irq disabled
+ */
+void NX_SMP_SetAffinityIrqDisabled(NX_Thread *thread, NX_CpuMask mask)
+{
+    NX_UArch coreId, newCoreId;
+    NX_Cpu *cpu;
+
+    while (1)
+    {
+        coreId = thread->onCore;
+        if (coreId >= NX_MULTI_CORES_NR) /* not on any core, placed when ready */
+        {
+            thread->coreAffinity = mask;
+            return;
+        }
+
+        cpu = NX_CpuGetIndex(coreId);
+        NX_SpinLock(&cpu->lock);
+        if (thread->onCore == coreId) /* not migrated while locking */
+        {
+            break;
+        }
+        NX_SpinUnlock(&cpu->lock);
+    }
+
+    thread->coreAffinity = mask;
+    if (NX_CpuMaskTest(mask, coreId))
+    {
+        NX_SpinUnlock(&cpu->lock);
+        return;
+    }
+
+    newCoreId = NX_SMP_FindIdlestCore(mask);
+    if (thread->onCpu) /* context in use on its core, moved when switched out */
+    {
+        NX_SpinUnlock(&cpu->lock);
+    }
+    else if (!NX_ListEmpty(&thread->list)) /* on ready list, move it now */
+    {
+        CpuReadyListDel(cpu, thread);
+        NX_AtomicDec(&cpu->threadCount);
+        NX_SMP_MigrateOut(coreId, thread);
+        thread->onCore = newCoreId;
+        NX_SpinUnlock(&cpu->lock);
+
+        NX_SMP_EnqueueThreadIrqDisabled(newCoreId, thread, NX_SCHED_TAIL | NX_SCHED_MIGRATED);
+        NX_SMP_KickCore(newCoreId, thread);
+    }
+    else if (thread->state == NX_THREAD_BLOCKED) /* wake places it on allowed core */
+    {
+        NX_SpinUnlock(&cpu->lock);
+    }
+    else /* parked, queued on new core next time */
+    {
+        thread->onCore = newCoreId;
+        NX_SpinUnlock(&cpu->lock);
+    }
+}
+
+/**
+ * thread switched out of current core, clear its on cpu flag in cpu lock, so affinity
+ * setter and waker see it either still on cpu or free. take the pending migration if
+ * it was queued here but its affinity changed while running. must called irq disabled
+ */
+void NX_SMP_SwitchOutDone(NX_Thread *thread)
+{
+    NX_Cpu *cpu = NX_CpuGetPtr();
+    NX_UArch newCoreId;
+
+    NX_SpinLock(&cpu->lock);
+    thread->onCpu = 0;
+
+    if (NX_CpuMaskTest(thread->coreAffinity, cpu->coreId) ||
+        thread->onCore != cpu->coreId || NX_ListEmpty(&thread->list))
+    {
+        NX_SpinUnlock(&cpu->lock);
+        return;
+    }
+
+    CpuReadyListDel(cpu, thread);
+    NX_AtomicDec(&cpu->threadCount);
+    NX_SMP_MigrateOut(cpu->coreId, thread);
+    newCoreId = NX_SMP_FindIdlestCore(thread->coreAffinity);
+    thread->onCore = newCoreId;
+    NX_SpinUnlock(&cpu->lock);
+
+    NX_SMP_EnqueueThreadIrqDisabled(newCoreId, thread, NX_SCHED_TAIL | NX_SCHED_MIGRATED);
+    NX_SMP_KickCore(newCoreId, thread);
+}
 
 NX_Thread *NX_SMP_PickThreadIrqDisabled(NX_UArch coreId)
 {
@@ -174,21 +617,48 @@ NX_Thread *NX_SMP_PickThreadIrqDisabled(NX_UArch coreId)
     
     NX_SpinLock(&cpu->lock);
     
-    for (prio = NX_THREAD_MAX_PRIORITY_NR - 1; prio >= 0; prio--)
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    /* deadline threads run before any priority thread */
+    if (cpu->deadlineReadyRoot != NX_NULL)
     {
-        thread = NX_ListFirstEntryOrNULL(&cpu->threadReadyList[prio], NX_Thread, list);
-        if (thread != NX_NULL)
+        thread = cpu->deadlineReadyRoot;
+    }
+    else
+#endif
+    {
+        prio = CpuReadyHighestPriority(cpu);
+
+#ifdef CONFIG_NX_SCHED_FAIR
+        /* fair threads run after real time and before idle priority */
+        if (prio < NX_THREAD_PRIORITY_LOW && cpu->fairReadyRoot != NX_NULL)
         {
-            break;
+            thread = cpu->fairReadyRoot;
         }
-    }
+        else
+#endif
+        {
+            /* at least one idle thread on core */
+            NX_ASSERT(prio >= 0);
 
-    /* at least one idle thread on core */
-    NX_ASSERT(thread);
+            thread = NX_ListFirstEntry(&cpu->threadReadyList[prio], NX_Thread, list);
+        }
+    }
 
-    NX_ListDel(&thread->list);
+    CpuReadyListDel(cpu, thread);
 
+#ifdef CONFIG_NX_SCHED_FAIR
+    if (NX_ThreadIsFair(thread))
+    {
+        /* the leftmost thread has min vruntime of the core */
+        if (thread->vruntime > cpu->fairMinVruntime)
+        {
+            cpu->fairMinVruntime = thread->vruntime;
+        }
+        thread->ticks = NX_SchedFairSlice(NX_SchedFairWeight(thread->priority), cpu->fairLoad);
+    }
+#else
     NX_ThreadLowerPriority(thread);
+#endif
 
     NX_AtomicDec(&cpu->threadCount);
 
@@ -198,37 +668,426 @@ NX_Thread *NX_SMP_PickThreadIrqDisabled(NX_UArch coreId)
 }
 
 /**
+ * thread leaves core for other one, fair thread keeps its lag to min vruntime of
+ * the core, based on new core when enqueued there with NX_SCHED_MIGRATED.
+ */
+void NX_SMP_MigrateOut(NX_UArch coreId, NX_Thread *thread)
+{
+#ifdef CONFIG_NX_SCHED_FAIR
+    if (NX_ThreadIsFair(thread))
+    {
+        thread->vruntime -= NX_CpuGetIndex(coreId)->fairMinVruntime;
+    }
+#endif
+}
+
+/**
+ * dequeue a ready thread allowed to run on `destCoreId` for migration,
+ * thread yielded but still switching out on its core is skipped.
  * NOTE: this must called irq disabled
  */
-NX_Thread *NX_SMP_DeququeNoAffinityThread(NX_UArch coreId)
+NX_Thread *NX_SMP_DequeueAllowedThread(NX_UArch coreId, NX_UArch destCoreId)
 {
     NX_Thread *thread, *findThread = NX_NULL;
     NX_Cpu *cpu = NX_CpuGetIndex(coreId);
-    int prio;
+    NX_U32 groups, bits;
+    int group, bit;
 
     NX_SpinLock(&cpu->lock);
     
-    for (prio = NX_THREAD_MAX_PRIORITY_NR - 1; prio >= 0; prio--)
+    /* only walk ready lists not empty, from highest priority */
+    for (groups = cpu->readyPriorityGroup; groups; groups &= ~(1U << group))
     {
-        NX_ListForEachEntry(thread, &cpu->threadReadyList[prio], list)
+        group = NX_FLS(groups) - 1;
+        for (bits = cpu->readyPriorityMap[group]; bits; bits &= ~(1U << bit))
         {
-            if (thread->coreAffinity >= NX_MULTI_CORES_NR) /* no affinity on any core */
+            bit = NX_FLS(bits) - 1;
+            NX_ListForEachEntry(thread, &cpu->threadReadyList[group * 32 + bit], list)
             {
-                findThread = thread;
-                NX_ListDel(&thread->list);
-                NX_AtomicDec(&cpu->threadCount);
-                goto out;
+                if (!thread->onCpu && NX_CpuMaskTest(thread->coreAffinity, destCoreId))
+                {
+                    findThread = thread;
+                    CpuReadyListDel(cpu, thread);
+                    NX_AtomicDec(&cpu->threadCount);
+                    goto out;
+                }
             }
         }
     }
 
+#ifdef CONFIG_NX_SCHED_FAIR
+    NX_ListForEachEntry(thread, &cpu->fairReadyList, list)
+    {
+        if (!thread->onCpu && NX_CpuMaskTest(thread->coreAffinity, destCoreId))
+        {
+            findThread = thread;
+            CpuReadyListDel(cpu, thread);
+            NX_AtomicDec(&cpu->threadCount);
+            goto out;
+        }
+    }
+#endif
+
 out:
+    if (findThread != NX_NULL)
+    {
+        NX_SMP_MigrateOut(coreId, findThread);
+    }
 
     NX_SpinUnlock(&cpu->lock);
 
     return findThread;
 }
 
+/**
+ * find the online core with the most ready threads except `coreId`,
+ * return NX_MULTI_CORES_NR if no other core online.
+ * only read per cpu thread count, no lock.
+ */
+NX_UArch NX_SMP_FindBusiestCore(NX_UArch coreId)
+{
+    NX_UArch i;
+    NX_UArch busiestCore = NX_MULTI_CORES_NR;
+    NX_IArch busiestCount = -1;
+    NX_IArch count;
+
+    for (i = 0; i < NX_MULTI_CORES_NR; i++)
+    {
+        if (i == coreId || cpuArray[i].online == NX_False)
+        {
+            continue;
+        }
+        count = NX_AtomicGet(&cpuArray[i].threadCount);
+        if (count > busiestCount)
+        {
+            busiestCount = count;
+            busiestCore = i;
+        }
+    }
+    return busiestCore;
+}
+
+/**
+ * ready thread count excludes the running one, but idle thread is counted instead
+ * when other thread running, so it is the count of non-idle runnable threads.
+ */
+NX_PRIVATE NX_U32 CpuLoad(NX_Cpu *cpu)
+{
+    NX_U32 load = NX_AtomicGet(&cpu->threadCount) * NX_SMP_LOAD_SCALE;
+
+    /* recent load counted, and runnable threads now counted at once */
+    return cpu->loadAvg > load ? cpu->loadAvg : load;
+}
+
+/**
+ * core is idle when only idle thread on it
+ */
+NX_PRIVATE NX_Bool CpuIdle(NX_Cpu *cpu)
+{
+    return (cpu->online == NX_True && NX_AtomicGet(&cpu->threadCount) == 0) ? NX_True : NX_False;
+}
+
+/**
+ * decay core load average by ticks passed, called by sched tick on local core
+ */
+void NX_SMP_UpdateLoad(NX_UArch coreId, NX_ClockTick ticks)
+{
+    NX_Cpu *cpu = NX_CpuGetIndex(coreId);
+    NX_U32 load = NX_AtomicGet(&cpu->threadCount) * NX_SMP_LOAD_SCALE;
+
+    /* old load almost gone after 32 ticks */
+    if (ticks > 32)
+    {
+        ticks = 32;
+    }
+    while (ticks--)
+    {
+        cpu->loadAvg = (cpu->loadAvg * 7 + load) / 8;
+    }
+}
+
+/**
+ * find the online core in `mask` with the least load, boot core first when even.
+ * if no core in mask online yet, return the first core in mask, thread waits there.
+ * only read per cpu load, no lock.
+ */
+NX_UArch NX_SMP_FindIdlestCore(NX_CpuMask mask)
+{
+    NX_UArch i;
+    NX_UArch idlestCore = NX_MULTI_CORES_NR;
+    NX_U32 idlestLoad = 0;
+    NX_U32 load;
+
+    if (NX_CpuMaskTest(mask, bootCoreId) && cpuArray[bootCoreId].online == NX_True)
+    {
+        idlestCore = bootCoreId;
+        idlestLoad = CpuLoad(&cpuArray[bootCoreId]);
+    }
+
+    for (i = 0; i < NX_MULTI_CORES_NR; i++)
+    {
+        if (cpuArray[i].online == NX_False || !NX_CpuMaskTest(mask, i))
+        {
+            continue;
+        }
+        load = CpuLoad(&cpuArray[i]);
+        if (idlestCore >= NX_MULTI_CORES_NR || load < idlestLoad)
+        {
+            idlestLoad = load;
+            idlestCore = i;
+        }
+    }
+
+    if (idlestCore >= NX_MULTI_CORES_NR)
+    {
+        idlestCore = NX_CpuMaskFirst(mask);
+    }
+    return idlestCore;
+}
+
+/**
+ * choose core for the woken thread in its affinity, in order:
+ * 1. previous core if still switching out there, or idle, cache still warm.
+ * 2. other idle core, cores share the last level cache on supported platforms.
+ * 3. waker core if not busier than previous core, producer and consumer share data.
+ * 4. the least loaded core.
+ */
+NX_UArch NX_SMP_SelectWakeCore(NX_Thread *thread)
+{
+    NX_UArch prevCoreId = thread->onCore;
+    NX_UArch wakerCoreId = NX_SMP_GetIdx();
+    NX_CpuMask mask = thread->coreAffinity;
+    NX_UArch i;
+
+    /* context still in use on previous core until switch finished, only it can pick thread */
+    if (thread->onCpu)
+    {
+        return prevCoreId;
+    }
+
+    if (prevCoreId >= NX_MULTI_CORES_NR || !NX_CpuMaskTest(mask, prevCoreId))
+    {
+        return NX_SMP_FindIdlestCore(mask);
+    }
+
+    if (CpuIdle(&cpuArray[prevCoreId]) == NX_True)
+    {
+        return prevCoreId;
+    }
+
+    for (i = 0; i < NX_MULTI_CORES_NR; i++)
+    {
+        if (NX_CpuMaskTest(mask, i) && CpuIdle(&cpuArray[i]) == NX_True)
+        {
+            return i;
+        }
+    }
+
+    if (NX_CpuMaskTest(mask, wakerCoreId) &&
+        CpuLoad(&cpuArray[wakerCoreId]) <= CpuLoad(&cpuArray[prevCoreId]))
+    {
+        return wakerCoreId;
+    }
+
+    return NX_SMP_FindIdlestCore(mask);
+}
+
+/**
+ * send inter-processor interrupt to other core
+ */
+NX_Error NX_SMP_SendIpi(NX_UArch coreId, NX_U32 ipi)
+{
+    if (coreId >= NX_MULTI_CORES_NR || !ipi)
+    {
+        return NX_EINVAL;
+    }
+
+    NX_Cpu *cpu = NX_CpuGetIndex(coreId);
+    if (cpu->online == NX_False)
+    {
+        return NX_ENORES;
+    }
+
+    NX_AtomicSetMask(&cpu->ipiPending, ipi);
+    return NX_SMP_OpsInterface.sendIpi(coreId);
+}
+
+/**
+ * run function called to current core if it is waited, called irq disabled
+ */
+NX_PRIVATE void SMP_CallRun(NX_CpuMask self)
+{
+    if (NX_AtomicGet(&callWait) & self)
+    {
+        /* see function set before wait mask */
+        NX_MemoryBarrierRead();
+        callFunc(callArg);
+        NX_MemoryBarrier();
+        NX_AtomicClearMask(&callWait, self);
+    }
+}
+
+/**
+ * run `func` on other online cores in `mask` by ipi, return after all of them done.
+ * must called irq disabled, and not hold locks other cores spin on with irq disabled.
+ * caller waiting for other call runs the call to itself, so two callers not deadlock.
+ */
+void NX_SMP_CallCores(NX_CpuMask mask, void (*func)(void *arg), void *arg)
+{
+    NX_UArch coreId;
+    NX_CpuMask self = NX_CpuMaskCore(NX_SMP_GetIdx());
+
+    mask &= ~self;
+    for (coreId = 0; coreId < NX_MULTI_CORES_NR; coreId++)
+    {
+        if (cpuArray[coreId].online == NX_False)
+        {
+            mask &= ~NX_CpuMaskCore(coreId);
+        }
+    }
+    if (mask == NX_CPUMASK_NONE)
+    {
+        return;
+    }
+
+    while (NX_SpinTryLock(&callLock) != NX_EOK)
+    {
+        SMP_CallRun(self);
+        NX_SMP_CpuRelax();
+    }
+
+    callFunc = func;
+    callArg = arg;
+    NX_MemoryBarrier();
+    NX_AtomicSet(&callWait, mask);
+
+    for (coreId = 0; coreId < NX_MULTI_CORES_NR; coreId++)
+    {
+        if (NX_CpuMaskTest(mask, coreId))
+        {
+            NX_SMP_SendIpi(coreId, NX_SMP_IPI_CALL);
+        }
+    }
+
+    while (NX_AtomicGet(&callWait) != 0)
+    {
+        NX_SMP_CpuRelax();
+    }
+    NX_SpinUnlock(&callLock);
+}
+
+/**
+ * other cores loaded page table `table` (virtual address), may run on it lazily,
+ * NX_NULL means kernel page table, all cores map it.
+ * page table is set before loaded, call after page table updated and memory barrier.
+ */
+NX_CpuMask NX_SMP_TableLoadedCores(void *table)
+{
+    NX_UArch coreId;
+    NX_CpuMask mask = NX_CPUMASK_NONE;
+
+    for (coreId = 0; coreId < NX_MULTI_CORES_NR; coreId++)
+    {
+        if (coreId != NX_SMP_GetIdx() && (table == NX_NULL || cpuArray[coreId].pageTable == table))
+        {
+            mask |= NX_CpuMaskCore(coreId);
+        }
+    }
+    return mask;
+}
+
+/**
+ * handle ipi on current core, called by arch with interrupt disabled
+ */
+void NX_SMP_IpiHandler(void)
+{
+    NX_Cpu *cpu = NX_CpuGetPtr();
+    NX_U32 ipi = NX_AtomicSwap(&cpu->ipiPending, 0);
+
+    if (ipi & NX_SMP_IPI_RESCHED)
+    {
+        /* sched when return from interrupt */
+        if (cpu->threadRunning != NX_NULL)
+        {
+            cpu->threadRunning->needSched = 1;
+        }
+    }
+
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+    if (ipi & NX_SMP_IPI_CLOCK)
+    {
+        NX_ClockEventUpdate();
+    }
+#endif
+
+    if (ipi & NX_SMP_IPI_CALL)
+    {
+        SMP_CallRun(NX_CpuMaskCore(cpu->coreId));
+    }
+}
+
+/**
+ * deadline thread outranks priority thread, earlier deadline outranks later one
+ */
+NX_PRIVATE NX_Bool ThreadOutrank(NX_Thread *thread, NX_Thread *running)
+{
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    if (NX_ThreadIsDeadline(thread) || NX_ThreadIsDeadline(running))
+    {
+        if (!NX_ThreadIsDeadline(thread))
+        {
+            return NX_False;
+        }
+        if (!NX_ThreadIsDeadline(running))
+        {
+            return NX_True;
+        }
+        return NX_DeadlineBefore(thread->dl.absDeadline, running->dl.absDeadline);
+    }
+#endif
+#ifdef CONFIG_NX_SCHED_FAIR
+    /* woken fair thread preempts only when it is well behind in vruntime */
+    if (NX_ThreadIsFair(thread) && NX_ThreadIsFair(running))
+    {
+        return thread->vruntime + NX_SchedFairWakeupLead() < running->vruntime;
+    }
+#endif
+    return thread->priority > running->priority;
+}
+
+/**
+ * kick core to reschedule when the thread queued on it outranks the running thread,
+ * local core preempt when return from interrupt or syscall, other core by ipi.
+ * must called interrupt disabled
+ */
+void NX_SMP_KickCore(NX_UArch coreId, NX_Thread *thread)
+{
+    NX_Thread *running;
+
+    if (coreId >= NX_MULTI_CORES_NR)
+    {
+        return;
+    }
+
+    running = NX_CpuGetIndex(coreId)->threadRunning;
+    if (running != NX_NULL && !ThreadOutrank(thread, running))
+    {
+        return;
+    }
+
+    if (coreId == NX_SMP_GetIdx())
+    {
+        if (running != NX_NULL)
+        {
+            running->needSched = 1;
+        }
+    }
+    else
+    {
+        NX_SMP_SendIpi(coreId, NX_SMP_IPI_RESCHED);
+    }
+}
+
 NX_Error NX_SMP_SetRunning(NX_UArch coreId, NX_Thread *thread)
 {
     if (coreId >= NX_MULTI_CORES_NR || thread == NX_NULL)
@@ -236,12 +1095,15 @@ NX_Error NX_SMP_SetRunning(NX_UArch coreId, NX_Thread *thread)
         return NX_EINVAL;
     }
 
+    /**
+     * no cpu lock here: lock and unlock would straddle the running thread change,
+     * then preempt count taken on prev thread released on next thread.
+     */
     NX_Cpu *cpu = NX_CpuGetIndex(coreId);
-    NX_UArch level;
-    NX_SpinLockIRQ(&cpu->lock, &level);
+    NX_UArch level = NX_IRQ_SaveLevel();
     thread->state = NX_THREAD_RUNNING;
     cpu->threadRunning = thread;
-    NX_SpinUnlockIRQ(&cpu->lock, level);
+    NX_IRQ_RestoreLevel(level);
     return NX_EOK;
 }
 
@@ -277,21 +1139,6 @@ NX_Thread * NX_SMP_GetIdle(NX_UArch coreId)
     return thread;
 }
 
-/**
- * get running thread
- */
-NX_Thread *NX_SMP_GetRunning(void)
-{
-    NX_Thread *thread;
-    NX_Cpu *cpu = NX_CpuGetPtr();
-    NX_ASSERT(cpu != NX_NULL);
-    NX_UArch level;
-    NX_SpinLockIRQ(&cpu->lock, &level);
-    thread = cpu->threadRunning;
-    NX_SpinUnlockIRQ(&cpu->lock, level);
-    return thread;
-}
-
 /**
  * get cpu usage
  */
@@ -311,3 +1158,16 @@ NX_U32 NX_SMP_GetUsage(NX_UArch coreId)
     NX_SpinUnlockIRQ(&cpu->lock, level);
     return usage;
 }
+
+/**
+ * get cpu idle time since boot in millisecond
+ */
+NX_U32 NX_SMP_GetIdleTime(NX_UArch coreId)
+{
+    if (coreId >= NX_MULTI_CORES_NR)
+    {
+        return 0;
+    }
+
+    return NX_ClockTickToMillisecond(NX_CpuGetIndex(coreId)->idleTicks);
+}
@@ -11,6 +11,14 @@
 
 #include <base/spin.h>
 #include <base/irq.h>
+#include <base/smp.h>
+#include <base/preempt.h>
+
+#ifdef CONFIG_NX_DEBUG
+#define SPIN_VALID(lock) ((lock) != NX_NULL && (lock)->magic == NX_SPIN_MAGIC)
+#else
+#define SPIN_VALID(lock) ((lock) != NX_NULL)
+#endif
 
 NX_Error NX_SpinInit(NX_Spin *lock)
 {
@@ -18,58 +26,93 @@ NX_Error NX_SpinInit(NX_Spin *lock)
     {
         return NX_EINVAL;
     }
+#ifdef CONFIG_NX_DEBUG
     if (lock->magic == NX_SPIN_MAGIC)
     {
         return NX_EFAULT;
     }
+#endif
 
-    NX_AtomicSet(&lock->value, 0);
+    NX_AtomicSet(&lock->next, 0);
+    NX_AtomicSet(&lock->owner, 0);
+#ifdef CONFIG_NX_DEBUG
     lock->magic = NX_SPIN_MAGIC;
+#endif
     return NX_EOK;
 }
 
 NX_Error NX_SpinTryLock(NX_Spin *lock)
 {
-    if (lock == NX_NULL || lock->magic != NX_SPIN_MAGIC)
+    NX_IArch owner;
+
+    if (!SPIN_VALID(lock))
     {
         return NX_EFAULT;
     }
 
-    if (NX_AtomicCAS(&lock->value, 0, NX_SPIN_LOCK_VALUE) == 0)
+    NX_PreemptDisable();
+
+    /* only take ticket when no one holding or waiting */
+    owner = NX_AtomicGet(&lock->owner);
+    if (NX_AtomicCAS(&lock->next, owner, owner + 1) == owner)
     {
         return NX_EOK;
     }
     else
     {
+        NX_PreemptEnable();
         return NX_ERROR;
     }
 }
 
 NX_Error NX_SpinLock(NX_Spin *lock)
 {
-    if (lock == NX_NULL || lock->magic != NX_SPIN_MAGIC)
+    NX_IArch ticket;
+
+    if (!SPIN_VALID(lock))
     {
         return NX_EFAULT;
     }
 
-    do
+    /* holder of a ticket must not be preempted, or all waiters spin until it back */
+    NX_PreemptDisable();
+
+    ticket = NX_AtomicFetchAdd(&lock->next, 1);
+    while (NX_AtomicGet(&lock->owner) != ticket)
+    {
+        NX_SMP_CpuRelax();
+    }
+
+    return NX_EOK;
+}
+
+/**
+ * release lock without preempt enable, return NX_EOK if lock was held
+ */
+NX_PRIVATE NX_Error SpinRelease(NX_Spin *lock)
+{
+    /* not locked, do nothing */
+    if (NX_AtomicGet(&lock->owner) == NX_AtomicGet(&lock->next))
     {
-        if (NX_SpinTryLock(lock) == NX_EOK)
-        {
-            break;
-        }
-    } while (1);
+        return NX_ENORES;
+    }
 
+    /* pass lock to next ticket */
+    NX_AtomicInc(&lock->owner);
     return NX_EOK;
 }
 
 NX_Error NX_SpinUnlock(NX_Spin *lock)
 {
-    if (lock == NX_NULL || lock->magic != NX_SPIN_MAGIC)
+    if (!SPIN_VALID(lock))
     {
         return NX_EFAULT;
     }
-    NX_AtomicSet(&lock->value, 0);
+
+    if (SpinRelease(lock) == NX_EOK)
+    {
+        NX_PreemptEnable();
+    }
     return NX_EOK;
 }
 
@@ -85,26 +128,35 @@ NX_Error NX_SpinLockIRQ(NX_Spin *lock, NX_UArch *level)
 
 NX_Error NX_SpinUnlockIRQ(NX_Spin *lock, NX_UArch level)
 {
+    NX_Error err;
+
     if (lock == NX_NULL)
     {
         return NX_EINVAL;
     }
-    if (NX_SpinUnlock(lock) != NX_EOK)
+    if (!SPIN_VALID(lock))
     {
         return NX_EFAULT;
     }
+    err = SpinRelease(lock);
     NX_IRQ_RestoreLevel(level);
+
+    /* preempt after irq restored, so pending preempt can be taken */
+    if (err == NX_EOK)
+    {
+        NX_PreemptEnable();
+    }
     return NX_EOK;
 }
 
 NX_Error NX_SpinState(NX_Spin *lock)
 {
-    if (lock == NX_NULL || lock->magic != NX_SPIN_MAGIC)
+    if (!SPIN_VALID(lock))
     {
         return NX_EFAULT;
     }
 
-    if (NX_AtomicGet(&lock->value) != 0)
+    if (NX_AtomicGet(&lock->owner) != NX_AtomicGet(&lock->next))
     {
         return NX_EBUSY;
     }
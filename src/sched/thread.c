@@ -27,6 +27,89 @@
 
 NX_ThreadManager gThreadManagerObject;
 
+/**
+ * thread object with stack cached on each core, only touched by local core with interrupt disabled
+ */
+struct ThreadCache
+{
+    NX_List freeList;
+    NX_U32 count;
+};
+NX_PRIVATE struct ThreadCache threadCache[NX_MULTI_CORES_NR];
+
+/**
+ * get thread object and stack from local cache, or alloc from heap
+ */
+NX_PRIVATE NX_Thread *ThreadAlloc(void)
+{
+    NX_Thread *thread = NX_NULL;
+    struct ThreadCache *cache;
+    NX_UArch level;
+
+    level = NX_IRQ_SaveLevel();
+    cache = &threadCache[NX_SMP_GetIdx()];
+    if (cache->count > 0)
+    {
+        thread = NX_ListFirstEntry(&cache->freeList, NX_Thread, list);
+        NX_ListDel(&thread->list);
+        cache->count--;
+    }
+    NX_IRQ_RestoreLevel(level);
+
+    if (thread != NX_NULL)
+    {
+        return thread;
+    }
+
+    thread = (NX_Thread *)NX_MemAlloc(sizeof(NX_Thread));
+    if (thread == NX_NULL)
+    {
+        return NX_NULL;
+    }
+    thread->stackBase = NX_MemAlloc(NX_THREAD_STACK_SIZE_DEFAULT);
+    if (thread->stackBase == NX_NULL)
+    {
+        NX_MemFree(thread);
+        return NX_NULL;
+    }
+    return thread;
+}
+
+/**
+ * put thread object and stack into local cache, free to heap if cache full
+ */
+NX_PRIVATE void ThreadFree(NX_Thread *thread, NX_U8 *stackBase)
+{
+    struct ThreadCache *cache;
+    NX_UArch level;
+
+    level = NX_IRQ_SaveLevel();
+    cache = &threadCache[NX_SMP_GetIdx()];
+    if (cache->count < NX_THREAD_CACHE_NR)
+    {
+        thread->stackBase = stackBase;
+        NX_ListAdd(&thread->list, &cache->freeList);
+        cache->count++;
+        NX_IRQ_RestoreLevel(level);
+        return;
+    }
+    NX_IRQ_RestoreLevel(level);
+
+    NX_MemFree(stackBase);
+    NX_MemFree(thread);
+}
+
+/**
+ * new thread starts here, finish the switch to it before run handler
+ */
+NX_PRIVATE void ThreadStartEntry(void *arg)
+{
+    NX_Thread *thread = (NX_Thread *)arg;
+
+    NX_SchedFinishSwitch();
+    thread->handler(thread->threadArg);
+}
+
 NX_PRIVATE NX_Error ThreadInit(NX_Thread *thread, 
     const char *name,
     NX_ThreadHandler handler, void *arg,
@@ -43,6 +126,7 @@ NX_PRIVATE NX_Error ThreadInit(NX_Thread *thread,
     NX_ListInit(&thread->exitList);
     NX_ListInit(&thread->processList);
     NX_ListInit(&thread->blockList);
+    NX_ListInit(&thread->mutexList);
 
     NX_StrCopy(thread->name, name);
     thread->tid = NX_ThreadIdAlloc();
@@ -55,22 +139,33 @@ NX_PRIVATE NX_Error ThreadInit(NX_Thread *thread,
     thread->handler = handler;
     thread->userHandler = NX_NULL;
     thread->threadArg = arg;
-    thread->timeslice = 3;
+    thread->timeslice = NX_THREAD_TIMESLICE;
     thread->elapsedTicks = 0;
     thread->ticks = thread->timeslice;
     thread->fixedPriority = priority;
     thread->priority = priority;
     thread->needSched = 0;
+    thread->preemptCount = 0;
+#ifdef CONFIG_NX_SCHED_FAIR
+    thread->vruntime = 0;   /* placed by min vruntime of core when first ready */
+#endif
+#if defined(CONFIG_NX_SCHED_DEADLINE) || defined(CONFIG_NX_SCHED_FAIR)
+    thread->readyChild = NX_NULL;
+    thread->readyNext = NX_NULL;
+    thread->readyPrev = NX_NULL;
+#endif
+    thread->waitMutex = NX_NULL;
     thread->isTerminated = 0;
     thread->stackBase = stack;
     thread->stackSize = stackSize;
     thread->stack = thread->stackBase + stackSize - sizeof(NX_UArch);
-    thread->stack = NX_ContextInit(handler, (void *)NX_ThreadExit, arg, thread->stack);
+    thread->stack = NX_ContextInit(ThreadStartEntry, (void *)NX_ThreadExit, thread, thread->stack);
     thread->userStackBase = NX_NULL;
     thread->userStackSize = 0;
 
     thread->onCore = NX_MULTI_CORES_NR; /* not on any core */
-    thread->coreAffinity = NX_MULTI_CORES_NR; /* no core affinity */
+    thread->onCpu = 0;
+    thread->coreAffinity = NX_CPUMASK_ALL; /* run on any core */
 
     thread->resource.sleepTimer = NX_NULL;
     thread->resource.process = NX_NULL;
@@ -82,6 +177,8 @@ NX_PRIVATE NX_Error ThreadInit(NX_Thread *thread,
     NX_SemaphoreInit(&thread->resource.waiterSem, 0);
     thread->resource.tls = NX_NULL;
 
+    NX_SchedDeadlineInit(thread);
+
     NX_SpinInit(&thread->lock);
     return NX_EOK;
 }
@@ -107,21 +204,15 @@ NX_Thread *NX_ThreadCreate(const char *name, NX_ThreadHandler handler, void *arg
         return NX_NULL;
     }
 
-    NX_Thread *thread = (NX_Thread *)NX_MemAlloc(sizeof(NX_Thread));
+    NX_Thread *thread = ThreadAlloc();
     if (thread == NX_NULL)
     {
         return NX_NULL;
     }
-    NX_U8 *stack = NX_MemAlloc(NX_THREAD_STACK_SIZE_DEFAULT);
-    if (stack == NX_NULL)
-    {
-        NX_MemFree(thread);
-        return NX_NULL;
-    }
+    NX_U8 *stack = thread->stackBase;
     if (ThreadInit(thread, name, handler, arg, stack, NX_THREAD_STACK_SIZE_DEFAULT, priority) != NX_EOK)
     {
-        NX_MemFree(stack);
-        NX_MemFree(thread);
+        ThreadFree(thread, stack);
         return NX_NULL;
     }
     return thread;
@@ -139,96 +230,100 @@ NX_Error NX_ThreadDestroy(NX_Thread *thread)
         return NX_EFAULT;
     }
 
+    /* thread not started may be admitted to deadline class */
+    NX_SchedDeadlineExit(thread);
+
     NX_Error err = ThreadDeInit(thread);
     if (err != NX_EOK)
     {
         return err;
     }
 
-    NX_MemFree(stackBase);
-    NX_MemFree(thread);
+    ThreadFree(thread, stackBase);
     return NX_EOK;
 }
 
-NX_PRIVATE void NX_ThreadAddToGlobalPendingList(NX_Thread *thread, int flags)
+void NX_ThreadReadyRunLocked(NX_Thread *thread, int flags)
 {
-    if (flags & NX_SCHED_HEAD)
+    NX_UArch coreId;
+
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    if (NX_ThreadIsDeadline(thread))
     {
-        NX_ListAdd(&thread->list, &gThreadManagerObject.pendingList);
+        NX_SchedDeadlineReadyRun(thread, flags);
     }
     else
+#endif
     {
-        NX_ListAddTail(&thread->list, &gThreadManagerObject.pendingList);
-    }
-    NX_AtomicInc(&gThreadManagerObject.pendingThreadCount);
-}
-
-NX_PRIVATE void NX_ThreadDelFromGlobalPendingList(NX_Thread *thread)
-{
-    NX_ListDel(&thread->list);
-    NX_AtomicDec(&gThreadManagerObject.pendingThreadCount);
-}
-
-void NX_ThreadReadyRunLocked(NX_Thread *thread, int flags)
-{
-    thread->state = NX_THREAD_READY;
+        if (thread->state == NX_THREAD_BLOCKED) /* woken thread may move to better core */
+        {
+            coreId = NX_SMP_SelectWakeCore(thread);
+            if (thread->onCore < NX_MULTI_CORES_NR && coreId != thread->onCore)
+            {
+                NX_SMP_MigrateOut(thread->onCore, thread);
+                flags |= NX_SCHED_MIGRATED;
+            }
+            thread->onCore = coreId;
+        }
+        thread->state = NX_THREAD_READY;
 
-    if (thread->onCore < NX_MULTI_CORES_NR) /* add to core pending list */
-    {
+        if (thread->onCore >= NX_MULTI_CORES_NR) /* place on the idlest core */
+        {
+            thread->onCore = NX_SMP_FindIdlestCore(thread->coreAffinity);
+        }
         NX_SMP_EnqueueThreadIrqDisabled(thread->onCore, thread, flags);
+
+        /* preempt the running thread if woken thread outranks it */
+        NX_SMP_KickCore(thread->onCore, thread);
     }
-    else /* add to global pending list */
+
+    /**
+     * queued on core not allowed while affinity change pending, its context was still
+     * in use there. move it now if switched out meanwhile, else moved when switched out.
+     */
+    if (!NX_CpuMaskTest(thread->coreAffinity, thread->onCore))
     {
-        NX_ThreadAddToGlobalPendingList(thread, flags);
+        NX_SMP_SetAffinityIrqDisabled(thread, thread->coreAffinity);
     }
 }
 
+/**
+ * ready run only touch the per cpu ready list, no global lock needed
+ */
 void NX_ThreadReadyRunUnlocked(NX_Thread *thread, int flags)
 {
-    NX_UArch level;
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
+    NX_UArch level = NX_IRQ_SaveLevel();
 
     NX_ThreadReadyRunLocked(thread, flags);
     
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
+    NX_IRQ_RestoreLevel(level);
 }
 
 void NX_ThreadUnreadyRunLocked(NX_Thread *thread)
 {
-    if (thread->onCore < NX_MULTI_CORES_NR) /* add to core pending list */
-    {
-        NX_SMP_DequeueThreadIrqDisabled(thread->onCore, thread);
-    }
-    else /* add to global pending list */
-    {
-        NX_ThreadDelFromGlobalPendingList(thread);
-    }
+    NX_ASSERT(thread->onCore < NX_MULTI_CORES_NR);
+    NX_SMP_DequeueThreadIrqDisabled(thread->onCore, thread);
 }
 
 void NX_ThreadUnreadyRun(NX_Thread *thread)
 {
     NX_ASSERT(thread->state != NX_THREAD_READY);
-
-    if (thread->onCore < NX_MULTI_CORES_NR) /* add to core pending list */
-    {        
-        NX_SMP_DequeueThread(thread->onCore, thread);
-    }
-    else /* add to global pending list */
-    {
-        NX_ThreadDequeuePendingList(thread);
-    }
+    NX_ASSERT(thread->onCore < NX_MULTI_CORES_NR);
+    NX_SMP_DequeueThread(thread->onCore, thread);
 }
 
 NX_INLINE void NX_ThreadEnququeGlobalListUnlocked(NX_Thread *thread)
 {
     NX_ListAdd(&thread->globalList, &gThreadManagerObject.globalList);    
     NX_AtomicInc(&gThreadManagerObject.activeThreadCount);
+    NX_ThreadIdBind(thread->tid, thread);
 }
 
 NX_INLINE void NX_ThreadDeququeGlobalListUnlocked(NX_Thread *thread)
 {
     NX_ListDel(&thread->globalList);
     NX_AtomicDec(&gThreadManagerObject.activeThreadCount);
+    NX_ThreadIdBind(thread->tid, NX_NULL);
 }
 
 NX_Error NX_ThreadStart(NX_Thread *thread)
@@ -239,14 +334,14 @@ NX_Error NX_ThreadStart(NX_Thread *thread)
     }
 
     NX_UArch level;
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
+    NX_RwLockWriteIRQ(&gThreadManagerObject.lock, &level);
 
     NX_ThreadEnququeGlobalListUnlocked(thread);
 
     /* add to ready list */
     NX_ThreadReadyRunLocked(thread, NX_SCHED_TAIL);
     
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
+    NX_RwUnlockWriteIRQ(&gThreadManagerObject.lock, level);
     return NX_EOK;
 }
 
@@ -258,11 +353,11 @@ NX_Error NX_ThreadStartNotReady(NX_Thread *thread)
     }
 
     NX_UArch level;
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
+    NX_RwLockWriteIRQ(&gThreadManagerObject.lock, &level);
 
     NX_ThreadEnququeGlobalListUnlocked(thread);
 
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
+    NX_RwUnlockWriteIRQ(&gThreadManagerObject.lock, level);
     return NX_EOK;
 }
 
@@ -311,10 +406,16 @@ NX_PRIVATE void ThreadReleaseResouce(NX_Thread *thread)
     /* NOTE: add other resource here. */
     if (thread->resource.sleepTimer != NX_NULL)
     {
-        NX_TimerStop(thread->resource.sleepTimer);
+        NX_HrTimerCancel(thread->resource.sleepTimer);
         thread->resource.sleepTimer = NX_NULL;
     }
 
+    /* leave mutex wait list and drop inherited priority */
+    NX_MutexThreadExit(thread);
+
+    /* give back deadline bandwidth */
+    NX_SchedDeadlineExit(thread);
+
     /* thread exit notify */
     ThreadExitNotify(thread);
 
@@ -336,23 +437,16 @@ void NX_ThreadExit(NX_U32 exitCode)
     ThreadReleaseResouce(thread);
 
     NX_UArch level;
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
+    NX_RwLockWriteIRQ(&gThreadManagerObject.lock, &level);
 
     NX_ThreadDeququeGlobalListUnlocked(thread);
 
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
+    NX_RwUnlockWriteIRQ(&gThreadManagerObject.lock, level);
     
     NX_SchedExit();
     NX_PANIC("Thread Exit should never arrive here!");
 }
 
-NX_Thread *NX_ThreadSelf(void)
-{
-    NX_Thread *cur = NX_SMP_GetRunning();
-    NX_ASSERT(cur != NX_NULL);
-    return cur;
-}
-
 /**
  * must called with interrupt disabled.
  */
@@ -425,7 +519,7 @@ NX_Error NX_ThreadUnblock(NX_Thread *thread)
     return NX_EBUSY;
 }
 
-NX_PRIVATE NX_Bool TimerThreadSleepTimeout(NX_Timer *timer, void *arg)
+NX_PRIVATE void TimerThreadSleepTimeout(NX_HrTimer *hrtimer, void *arg)
 {
     NX_Thread *thread = (NX_Thread *)arg; /* the thread wait for timeout  */
 
@@ -435,25 +529,19 @@ NX_PRIVATE NX_Bool TimerThreadSleepTimeout(NX_Timer *timer, void *arg)
     {
         NX_LOG_E("Wakeup thread:%s/%d failed!", thread->name, thread->tid);
     }
-    
-    return NX_True;
 }
 
-/* if thread sleep less equal than 2ms, use delay instead */
-#define THREAD_SLEEP_TIMEOUT_THRESHOLD 2
-
-NX_Error NX_ThreadSleep(NX_UArch microseconds)
+/**
+ * sleep on hrtimer of current core, not rounded to clock tick
+ */
+NX_Error NX_ThreadSleepNanosecond(NX_U64 nanoseconds)
 {
-    if (microseconds == 0)
+    if (nanoseconds == 0)
     {
         return NX_EINVAL;
     }
-    if (microseconds <= THREAD_SLEEP_TIMEOUT_THRESHOLD)
-    {
-        return NX_ClockTickDelayMillisecond(microseconds);
-    }
 
-    NX_Timer sleepTimer;
+    NX_HrTimer sleepTimer;
     NX_Error err;
 
     NX_UArch irqLevel = NX_IRQ_SaveLevel();
@@ -466,7 +554,7 @@ NX_Error NX_ThreadSleep(NX_UArch microseconds)
         NX_PANIC("thread sleep was terminate but exit failed");
     }
 
-    err = NX_TimerInit(&sleepTimer, microseconds, TimerThreadSleepTimeout, (void *)self, NX_TIMER_ONESHOT);
+    err = NX_HrTimerInit(&sleepTimer, TimerThreadSleepTimeout, (void *)self);
     if (err != NX_EOK)
     {
         NX_IRQ_RestoreLevel(irqLevel);
@@ -475,7 +563,7 @@ NX_Error NX_ThreadSleep(NX_UArch microseconds)
 
     self->resource.sleepTimer = &sleepTimer;
 
-    NX_TimerStart(self->resource.sleepTimer);
+    NX_HrTimerStart(self->resource.sleepTimer, nanoseconds);
 
     /* set thread as sleep state */
     NX_ThreadBlockInterruptDisabled(self, irqLevel);
@@ -484,7 +572,7 @@ NX_Error NX_ThreadSleep(NX_UArch microseconds)
     if (self->resource.sleepTimer != NX_NULL)
     {
         /* timer not stop now */
-        NX_TimerStop(self->resource.sleepTimer);
+        NX_HrTimerCancel(self->resource.sleepTimer);
         self->resource.sleepTimer = NX_NULL;
 
         /* must exit if terminated */
@@ -498,48 +586,56 @@ NX_Error NX_ThreadSleep(NX_UArch microseconds)
     return NX_EOK;
 }
 
-NX_Error NX_ThreadSetAffinity(NX_Thread *thread, NX_UArch coreId)
+NX_Error NX_ThreadSleep(NX_UArch milliseconds)
 {
-    if (thread == NX_NULL || coreId >= NX_MULTI_CORES_NR)
+    if (milliseconds == 0)
     {
         return NX_EINVAL;
     }
-    NX_UArch level;
-    NX_SpinLockIRQ(&thread->lock, &level);
-    thread->coreAffinity = coreId;
-    thread->onCore = coreId;
-    NX_SpinUnlockIRQ(&thread->lock, level);
-    return NX_EOK;
+    return NX_ThreadSleepNanosecond((NX_U64)milliseconds * NX_NANOSECOND_PER_MILLISECOND);
 }
 
-void NX_ThreadEnqueuePendingList(NX_Thread *thread)
+/**
+ * bind thread on one core
+ */
+NX_Error NX_ThreadSetAffinity(NX_Thread *thread, NX_UArch coreId)
 {
-    NX_UArch level;
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
-    NX_ThreadAddToGlobalPendingList(thread, NX_SCHED_HEAD);
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
+    if (coreId >= NX_MULTI_CORES_NR)
+    {
+        return NX_EINVAL;
+    }
+    return NX_ThreadSetAffinityMask(thread, NX_CpuMaskCore(coreId));
 }
 
-void NX_ThreadDequeuePendingList(NX_Thread *thread)
+/**
+ * set cores thread allowed to run on, thread on other core moved to an allowed one
+ */
+NX_Error NX_ThreadSetAffinityMask(NX_Thread *thread, NX_CpuMask mask)
 {
     NX_UArch level;
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
-    NX_ThreadDelFromGlobalPendingList(thread);
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
-}
 
-NX_Thread *NX_ThreadPickPendingList(void)
-{
-    NX_Thread *thread;
-    NX_SpinLock(&gThreadManagerObject.lock);
-    thread = NX_ListFirstEntryOrNULL(&gThreadManagerObject.pendingList, NX_Thread, list);
-    if (thread != NX_NULL)
+    mask &= NX_CPUMASK_ALL;
+    if (thread == NX_NULL || mask == NX_CPUMASK_NONE)
     {
-        NX_ListDel(&thread->list);
-        NX_AtomicDec(&gThreadManagerObject.pendingThreadCount);
+        return NX_EINVAL;
     }
-    NX_SpinUnlock(&gThreadManagerObject.lock);
-    return thread;
+
+    /* deadline thread is bound to the core admitted it */
+    if (NX_ThreadIsDeadline(thread))
+    {
+        return NX_EBUSY;
+    }
+
+    level = NX_IRQ_SaveLevel();
+    NX_SMP_SetAffinityIrqDisabled(thread, mask);
+    NX_IRQ_RestoreLevel(level);
+
+    /* current thread leave the core not allowed */
+    if (thread == NX_ThreadSelf() && !NX_CpuMaskTest(mask, NX_SMP_GetIdx()))
+    {
+        NX_ThreadYield();
+    }
+    return NX_EOK;
 }
 
 void NX_ThreadEnququeExitList(NX_Thread *thread)
@@ -549,6 +645,9 @@ void NX_ThreadEnququeExitList(NX_Thread *thread)
     NX_ASSERT(!NX_ListFind(&thread->exitList, &gThreadManagerObject.exitList));
     NX_ListAdd(&thread->exitList, &gThreadManagerObject.exitList);
     NX_SpinUnlockIRQ(&gThreadManagerObject.exitLock, level);
+
+    /* wakeup deamon to release thread */
+    NX_SemaphoreSignal(&gThreadManagerObject.exitSem);
 }
 
 NX_Thread *NX_ThreadDeququeExitList(void)
@@ -568,21 +667,15 @@ NX_Thread *NX_ThreadDeququeExitList(void)
 
 NX_Thread *NX_ThreadFindById(NX_U32 tid)
 {
-    NX_Thread *thread = NX_NULL, *find = NX_NULL;
+    NX_Thread *find = NX_NULL;
     NX_UArch level;
 
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
+    NX_RwLockReadIRQ(&gThreadManagerObject.lock, &level);
 
-    NX_ListForEachEntry (thread, &gThreadManagerObject.globalList, globalList)
-    {
-        if (thread->tid == tid)
-        {
-            find = thread;
-            break;
-        }
-    }
+    /* only thread on global list bind on id */
+    find = NX_ThreadIdToThread(tid);
 
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
+    NX_RwUnlockReadIRQ(&gThreadManagerObject.lock, level);
     return find;
 }
 
@@ -597,7 +690,7 @@ NX_Error NX_ThreadWalk(NX_ThreadWalkHandler handler, void * arg)
         return NX_EINVAL;
     }
 
-    NX_SpinLockIRQ(&gThreadManagerObject.lock, &level);
+    NX_RwLockReadIRQ(&gThreadManagerObject.lock, &level);
 
     NX_ListForEachEntry (thread, &gThreadManagerObject.globalList, globalList)
     {
@@ -607,7 +700,7 @@ NX_Error NX_ThreadWalk(NX_ThreadWalkHandler handler, void * arg)
         }
     }
 
-    NX_SpinUnlockIRQ(&gThreadManagerObject.lock, level);
+    NX_RwUnlockReadIRQ(&gThreadManagerObject.lock, level);
 
     return err;
 }
@@ -641,14 +734,19 @@ NX_Error NX_ThreadWait(NX_Thread * thread, NX_U32 *exitCode)
 
 void NX_ThreadManagerInit(void)
 {
-    NX_AtomicSet(&gThreadManagerObject.averageThreadThreshold, 0);
+    int i;
+    for (i = 0; i < NX_MULTI_CORES_NR; i++)
+    {
+        NX_ListInit(&threadCache[i].freeList);
+        threadCache[i].count = 0;
+    }
+
     NX_AtomicSet(&gThreadManagerObject.activeThreadCount, 0);
-    NX_AtomicSet(&gThreadManagerObject.pendingThreadCount, 0);
     NX_ListInit(&gThreadManagerObject.exitList);
+    NX_SemaphoreInit(&gThreadManagerObject.exitSem, 0);
     NX_ListInit(&gThreadManagerObject.globalList);
-    NX_ListInit(&gThreadManagerObject.pendingList);
     
-    NX_SpinInit(&gThreadManagerObject.lock);
+    NX_RwLockInit(&gThreadManagerObject.lock);
     NX_SpinInit(&gThreadManagerObject.exitLock);
 }
 
@@ -10,35 +10,77 @@
  */
 
 #include <base/thread_id.h>
-#include <base/malloc.h>
+#include <base/bitops.h>
 #include <base/debug.h>
 #include <base/memory.h>
 
 NX_PRIVATE struct NX_ThreadID threadIdObject;
 
+/**
+ * find free id from id `from` to max id, return -1 if no free id
+ */
+NX_PRIVATE int ThreadIdFindFree(NX_U32 from)
+{
+    NX_U32 word = from / 32;
+    NX_U32 bits;
+    NX_U32 fullWord;
+
+    /* ignore ids before from in first word */
+    bits = threadIdObject.maps[word] | ((1U << (from % 32)) - 1);
+    if (~bits)
+    {
+        return word * 32 + NX_FFS(~bits) - 1;
+    }
+
+    /* find a not full word in full maps */
+    word++;
+    if (word >= NX_THREAD_ID_WORDS)
+    {
+        return -1;
+    }
+    fullWord = word / 32;
+    bits = threadIdObject.fullMaps[fullWord] | ((1U << (word % 32)) - 1);
+    while (1)
+    {
+        if (~bits)
+        {
+            word = fullWord * 32 + NX_FFS(~bits) - 1;
+            return word * 32 + NX_FFS(~threadIdObject.maps[word]) - 1;
+        }
+        if (++fullWord >= NX_THREAD_ID_FULL_WORDS)
+        {
+            break;
+        }
+        bits = threadIdObject.fullMaps[fullWord];
+    }
+    return -1;
+}
+
 int NX_ThreadIdAlloc(void)
 {
     NX_UArch level;
     NX_SpinLockIRQ(&threadIdObject.idLock, &level);
 
-    NX_U32 nextID = threadIdObject.nextID;
-    do 
+    /* alloc id after last one, wrap to 0 if none */
+    int id = ThreadIdFindFree(threadIdObject.nextID);
+    if (id < 0 && threadIdObject.nextID > 0)
     {
-        NX_U32 idx = nextID / 32;
-        NX_U32 odd = nextID % 32;
-        if (!(threadIdObject.maps[idx] & (1 << odd)))
+        id = ThreadIdFindFree(0);
+    }
+
+    if (id >= 0)
+    {
+        NX_U32 idx = id / 32;
+        /* mark id used */
+        threadIdObject.maps[idx] |= (1U << (id % 32));
+        if (threadIdObject.maps[idx] == ~0U)
         {
-            /* mark id used */
-            threadIdObject.maps[idx] |= (1 << odd);
-            /* set next id */
-            threadIdObject.nextID = (nextID + 1) % NX_MAX_THREAD_NR;
-            break;
+            threadIdObject.fullMaps[idx / 32] |= (1U << (idx % 32));
         }
-        nextID = (nextID + 1) % NX_MAX_THREAD_NR;
-    } while (nextID != threadIdObject.nextID);
+        /* set next id */
+        threadIdObject.nextID = (id + 1) % NX_MAX_THREAD_NR;
+    }
 
-    /* nextID == threadIdObject.nextID means no id free */
-    int id = (nextID != threadIdObject.nextID) ? nextID : -1;
     NX_SpinUnlockIRQ(&threadIdObject.idLock, level);
     return id;
 }
@@ -54,16 +96,55 @@ void NX_ThreadIdFree(int id)
     NX_SpinLockIRQ(&threadIdObject.idLock, &level);
     NX_U32 idx = id / 32;
     NX_U32 odd = id % 32;
-    NX_ASSERT(threadIdObject.maps[idx] & (1 << odd));
-    threadIdObject.maps[idx] &= ~(1 << odd);   /* clear id */
+    NX_ASSERT(threadIdObject.maps[idx] & (1U << odd));
+    threadIdObject.maps[idx] &= ~(1U << odd);   /* clear id */
+    threadIdObject.fullMaps[idx / 32] &= ~(1U << (idx % 32));
+    threadIdObject.threads[id] = NX_NULL;
     NX_SpinUnlockIRQ(&threadIdObject.idLock, level);
 }
 
+/**
+ * bind thread on id, called with thread manager lock held
+ */
+void NX_ThreadIdBind(int id, struct NX_Thread *thread)
+{
+    if (id < 0 || id >= NX_MAX_THREAD_NR)
+    {
+        return;
+    }
+    threadIdObject.threads[id] = thread;
+}
+
+struct NX_Thread *NX_ThreadIdToThread(int id)
+{
+    if (id < 0 || id >= NX_MAX_THREAD_NR)
+    {
+        return NX_NULL;
+    }
+    return threadIdObject.threads[id];
+}
+
 void NX_ThreadsInitID(void)
 {
-    threadIdObject.maps = NX_MemAlloc(NX_MAX_THREAD_NR / 8);
-    NX_ASSERT(threadIdObject.maps != NX_NULL);
-    NX_MemZero(threadIdObject.maps, NX_MAX_THREAD_NR / 8);
+    int i;
+
+    NX_MemZero(&threadIdObject, sizeof(threadIdObject));
+
+    /* ids over max id in last word always used */
+    for (i = NX_MAX_THREAD_NR; i < NX_THREAD_ID_WORDS * 32; i++)
+    {
+        threadIdObject.maps[i / 32] |= (1U << (i % 32));
+    }
+    if (threadIdObject.maps[NX_THREAD_ID_WORDS - 1] == ~0U)
+    {
+        threadIdObject.fullMaps[(NX_THREAD_ID_WORDS - 1) / 32] |= (1U << ((NX_THREAD_ID_WORDS - 1) % 32));
+    }
+    /* words over max word always full */
+    for (i = NX_THREAD_ID_WORDS; i < NX_THREAD_ID_FULL_WORDS * 32; i++)
+    {
+        threadIdObject.fullMaps[i / 32] |= (1U << (i % 32));
+    }
+
     threadIdObject.nextID = 0;
     NX_SpinInit(&threadIdObject.idLock);
 }
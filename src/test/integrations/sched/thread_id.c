@@ -15,6 +15,9 @@
 
 #ifdef CONFIG_NX_TEST_INTEGRATION_THREAD_ID
 
+NX_PRIVATE int allocIds[NX_MAX_THREAD_NR];
+NX_PRIVATE NX_Bool idAllocated[NX_MAX_THREAD_NR];
+
 NX_INTEGRATION_TEST(TestThreadID)
 {
     int i;
@@ -31,7 +34,60 @@ NX_INTEGRATION_TEST(TestThreadID)
         NX_LOG_D("alloc id: %d", id);
         NX_ThreadIdFree(id);
     }
-    return NX_EOK;
+
+    /* alloc all free ids, they must be different and cross the 32 ids word boundary */
+    int count;
+    int id;
+    NX_Error err = NX_EOK;
+
+    for (i = 0; i < NX_MAX_THREAD_NR; i++)
+    {
+        idAllocated[i] = NX_False;
+    }
+    for (count = 0; count <= NX_MAX_THREAD_NR; count++)
+    {
+        id = NX_ThreadIdAlloc();
+        if (id < 0)
+        {
+            break;
+        }
+        if (count == NX_MAX_THREAD_NR || id >= NX_MAX_THREAD_NR || idAllocated[id] == NX_True)
+        {
+            NX_LOG_E("alloc bad id: %d, count: %d", id, count);
+            if (id < NX_MAX_THREAD_NR && idAllocated[id] == NX_False)
+            {
+                NX_ThreadIdFree(id);
+            }
+            err = NX_ERROR;
+            goto out;
+        }
+        idAllocated[id] = NX_True;
+        allocIds[count] = id;
+    }
+
+    /* all ids used, alloc fails until one freed */
+    if (id != -1 || count <= 32 || NX_ThreadIdAlloc() != -1)
+    {
+        NX_LOG_E("alloc not failed when full, ret: %d, count: %d", id, count);
+        err = NX_ERROR;
+        goto out;
+    }
+    NX_ThreadIdFree(allocIds[count - 1]);
+    id = NX_ThreadIdAlloc();
+    if (id != allocIds[count - 1])
+    {
+        NX_LOG_E("alloc id: %d, not the only free one: %d", id, allocIds[count - 1]);
+        NX_ThreadIdFree(id);
+        count--;
+        err = NX_ERROR;
+    }
+
+out:
+    while (--count >= 0)
+    {
+        NX_ThreadIdFree(allocIds[count]);
+    }
+    return err;
 }
 
 #endif
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: futex test 
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/futex.h>
+#include <base/thread.h>
+#include <test/utest.h>
+
+#ifdef CONFIG_NX_UTEST_SCHED_FUTEX
+
+NX_PRIVATE NX_U32 futexWord = 0;
+NX_PRIVATE NX_VOLATILE NX_Error futexWaitErr = NX_ERROR;
+NX_PRIVATE NX_VOLATILE int futexWaitDone = 0;
+
+NX_TEST(NX_FutexWait)
+{
+    NX_U32 word[2] = {1, 1};
+
+    NX_EXPECT_EQ(NX_FutexWait(NX_NULL, 0), NX_EINVAL);
+    NX_EXPECT_EQ(NX_FutexWait((NX_U32 *)((NX_U8 *)word + 1), 1), NX_EINVAL);
+
+    /* value changed, return without block */
+    NX_EXPECT_EQ(NX_FutexWait(&word[0], 0), NX_EAGAIN);
+    word[1] = 2;
+    NX_EXPECT_EQ(NX_FutexWait(&word[1], 1), NX_EAGAIN);
+}
+
+NX_TEST(NX_FutexWake)
+{
+    NX_U32 word = 0;
+    NX_Size waked = 1;
+
+    NX_EXPECT_EQ(NX_FutexWake(NX_NULL, 1, NX_NULL), NX_EINVAL);
+
+    /* no waiter on word */
+    NX_EXPECT_EQ(NX_FutexWake(&word, 1, &waked), NX_EOK);
+    NX_EXPECT_EQ(waked, 0);
+    NX_EXPECT_EQ(NX_FutexWake(&word, NX_FUTEX_WAKE_ALL, NX_NULL), NX_EOK);
+}
+
+NX_PRIVATE void NX_FutexWaiter1(void *arg)
+{
+    futexWaitErr = NX_FutexWait(&futexWord, 0);
+    futexWaitDone = 1;
+}
+
+NX_TEST(NX_FutexWaitWake)
+{
+    NX_Size waked = 0;
+
+    NX_Thread *thread = NX_ThreadCreate("futex1", NX_FutexWaiter1, NX_NULL, NX_THREAD_PRIORITY_NORMAL);
+    NX_EXPECT_NOT_NULL(thread);
+    NX_EXPECT_EQ(NX_ThreadStart(thread), NX_EOK);
+
+    /* waiter blocked on word */
+    NX_EXPECT_EQ(NX_ThreadSleep(100), NX_EOK);
+    NX_EXPECT_EQ(futexWaitDone, 0);
+
+    NX_EXPECT_EQ(NX_FutexWake(&futexWord, 1, &waked), NX_EOK);
+    NX_EXPECT_EQ(waked, 1);
+
+    /* sleep until waiter returned */
+    NX_EXPECT_EQ(NX_ThreadSleep(100), NX_EOK);
+    NX_EXPECT_EQ(futexWaitDone, 1);
+    NX_EXPECT_EQ(futexWaitErr, NX_EOK);
+}
+
+NX_TEST_TABLE(NX_Futex)
+{
+    NX_TEST_UNIT(NX_FutexWait),
+    NX_TEST_UNIT(NX_FutexWake),
+    NX_TEST_UNIT(NX_FutexWaitWake),
+};
+
+NX_TEST_CASE(NX_Futex);
+
+#endif
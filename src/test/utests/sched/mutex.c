@@ -10,6 +10,7 @@
  */
 
 #include <base/mutex.h>
+#include <base/thread.h>
 #include <test/utest.h>
 
 #ifdef CONFIG_NX_UTEST_SCHED_MUTEX
@@ -19,7 +20,9 @@ NX_TEST(NX_MutexInit)
     NX_Mutex lock;
     NX_EXPECT_NE(NX_MutexInit(NX_NULL), NX_EOK);
     NX_EXPECT_EQ(NX_MutexInit(&lock), NX_EOK);
+#ifdef CONFIG_NX_DEBUG  /* spin magic only checked in debug */
     NX_EXPECT_NE(NX_MutexInit(&lock), NX_EOK);
+#endif
 }
 
 NX_TEST(NX_MutexLock)
@@ -64,12 +67,36 @@ NX_TEST(NX_MutexLockAndUnlock)
     }
 }
 
+NX_TEST(NX_MutexCeiling)
+{
+    NX_Mutex lock;
+    NX_Thread *self = NX_ThreadSelf();
+
+    NX_EXPECT_EQ(NX_MutexInit(&lock), NX_EOK);
+
+    NX_EXPECT_NE(NX_MutexSetCeiling(NX_NULL, 0), NX_EOK);
+    NX_EXPECT_NE(NX_MutexSetCeiling(&lock, NX_THREAD_MAX_PRIORITY_NR), NX_EOK);
+    NX_EXPECT_EQ(NX_MutexSetCeiling(&lock, NX_THREAD_PRIORITY_RT_MAX), NX_EOK);
+
+    /* owner run at ceiling priority, restored after unlock */
+    NX_EXPECT_EQ(NX_MutexLock(&lock), NX_EOK);
+    NX_EXPECT_EQ(self->priority, NX_THREAD_PRIORITY_RT_MAX);
+    NX_EXPECT_EQ(NX_MutexUnlock(&lock), NX_EOK);
+    NX_EXPECT_LE(self->priority, self->fixedPriority);
+
+    NX_EXPECT_EQ(NX_MutexTryLock(&lock), NX_EOK);
+    NX_EXPECT_EQ(self->priority, NX_THREAD_PRIORITY_RT_MAX);
+    NX_EXPECT_EQ(NX_MutexUnlock(&lock), NX_EOK);
+    NX_EXPECT_LE(self->priority, self->fixedPriority);
+}
+
 NX_TEST_TABLE(NX_Mutex)
 {
     NX_TEST_UNIT(NX_MutexInit),
     NX_TEST_UNIT(NX_MutexLock),
     NX_TEST_UNIT(NX_MutexUnlock),
     NX_TEST_UNIT(NX_MutexLockAndUnlock),
+    NX_TEST_UNIT(NX_MutexCeiling),
 };
 
 NX_TEST_CASE(NX_Mutex);
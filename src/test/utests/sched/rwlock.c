@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: reader-writer lock test 
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/rwlock.h>
+#include <base/seqlock.h>
+#include <test/utest.h>
+
+#ifdef CONFIG_NX_UTEST_SCHED_RWLOCK
+
+NX_TEST(NX_RwLockInit)
+{
+    NX_RwLock lock;
+    NX_EXPECT_NE(NX_RwLockInit(NX_NULL), NX_EOK);
+    NX_EXPECT_EQ(NX_RwLockInit(&lock), NX_EOK);
+#ifdef CONFIG_NX_DEBUG  /* magic only checked in debug */
+    NX_EXPECT_NE(NX_RwLockInit(&lock), NX_EOK);
+#endif
+}
+
+NX_TEST(NX_RwLockRead)
+{
+    NX_RwLock lock;
+
+    NX_EXPECT_EQ(NX_RwLockInit(&lock), NX_EOK);
+
+    NX_EXPECT_NE(NX_RwLockRead(NX_NULL), NX_EOK);
+
+    /* readers share the lock */
+    NX_EXPECT_EQ(NX_RwLockRead(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_RwLockTryRead(&lock), NX_EOK);
+    NX_EXPECT_NE(NX_RwLockTryWrite(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_RwUnlockRead(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_RwUnlockRead(&lock), NX_EOK);
+    NX_EXPECT_NE(NX_RwUnlockRead(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_RwLockState(&lock), NX_EOK);
+}
+
+NX_TEST(NX_RwLockWrite)
+{
+    NX_RwLock lock;
+
+    NX_EXPECT_EQ(NX_RwLockInit(&lock), NX_EOK);
+
+    NX_EXPECT_NE(NX_RwLockWrite(NX_NULL), NX_EOK);
+
+    /* writer exclusive */
+    NX_EXPECT_EQ(NX_RwLockWrite(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_RwLockState(&lock), NX_EBUSY);
+    NX_EXPECT_NE(NX_RwLockTryRead(&lock), NX_EOK);
+    NX_EXPECT_NE(NX_RwLockTryWrite(&lock), NX_EOK);
+    NX_EXPECT_NE(NX_RwUnlockRead(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_RwUnlockWrite(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_RwLockState(&lock), NX_EOK);
+}
+
+NX_TEST(NX_RwLockIRQ)
+{
+    NX_RwLock lock;
+    NX_UArch level;
+    
+    NX_EXPECT_EQ(NX_RwLockInit(&lock), NX_EOK);
+
+    int i;
+    for (i = 0; i < 12; i++)
+    {
+        NX_EXPECT_EQ(NX_RwLockReadIRQ(&lock, &level), NX_EOK);
+        NX_EXPECT_EQ(NX_RwUnlockReadIRQ(&lock, level), NX_EOK);
+        NX_EXPECT_EQ(NX_RwLockWriteIRQ(&lock, &level), NX_EOK);
+        NX_EXPECT_EQ(NX_RwUnlockWriteIRQ(&lock, level), NX_EOK);
+    }
+}
+
+NX_TEST(NX_SeqLock)
+{
+    NX_SeqLock seq;
+    NX_UArch sequence;
+    NX_UArch level;
+
+    NX_SeqLockInit(&seq);
+
+    sequence = NX_SeqReadBegin(&seq);
+    NX_EXPECT_EQ(NX_SeqReadRetry(&seq, sequence), NX_False);
+
+    /* write during read, reader must retry */
+    NX_SeqWriteLock(&seq, &level);
+    NX_SeqWriteUnlock(&seq, level);
+    NX_EXPECT_EQ(NX_SeqReadRetry(&seq, sequence), NX_True);
+
+    sequence = NX_SeqReadBegin(&seq);
+    NX_EXPECT_EQ(NX_SeqReadRetry(&seq, sequence), NX_False);
+}
+
+NX_TEST_TABLE(NX_RwLock)
+{
+    NX_TEST_UNIT(NX_RwLockInit),
+    NX_TEST_UNIT(NX_RwLockRead),
+    NX_TEST_UNIT(NX_RwLockWrite),
+    NX_TEST_UNIT(NX_RwLockIRQ),
+    NX_TEST_UNIT(NX_SeqLock),
+};
+
+NX_TEST_CASE(NX_RwLock);
+
+#endif
@@ -19,18 +19,22 @@ NX_TEST(NX_SpinInit)
     NX_Spin lock;
     NX_EXPECT_NE(NX_SpinInit(NX_NULL), NX_EOK);
     NX_EXPECT_EQ(NX_SpinInit(&lock), NX_EOK);
+#ifdef CONFIG_NX_DEBUG  /* magic only checked in debug */
     NX_EXPECT_NE(NX_SpinInit(&lock), NX_EOK);
+#endif
 }
 
 NX_TEST(NX_SpinLock)
 {
     NX_Spin lock;
-    NX_Spin lockNoInit;
 
     NX_EXPECT_EQ(NX_SpinInit(&lock), NX_EOK);
 
     NX_EXPECT_NE(NX_SpinLock(NX_NULL), NX_EOK);
+#ifdef CONFIG_NX_DEBUG  /* magic only checked in debug */
+    NX_Spin lockNoInit;
     NX_EXPECT_NE(NX_SpinLock(&lockNoInit), NX_EOK);
+#endif
 
     NX_EXPECT_EQ(NX_SpinLock(&lock), NX_EOK);
     NX_EXPECT_NE(NX_SpinTryLock(&lock), NX_EOK);
@@ -39,12 +43,14 @@ NX_TEST(NX_SpinLock)
 NX_TEST(NX_SpinUnlock)
 {
     NX_Spin lock;
-    NX_Spin lockNoInit;
     
     NX_EXPECT_EQ(NX_SpinInit(&lock), NX_EOK);
 
     NX_EXPECT_NE(NX_SpinUnlock(NX_NULL), NX_EOK);
+#ifdef CONFIG_NX_DEBUG  /* magic only checked in debug */
+    NX_Spin lockNoInit;
     NX_EXPECT_NE(NX_SpinUnlock(&lockNoInit), NX_EOK);
+#endif
 
     NX_EXPECT_EQ(NX_SpinLock(&lock), NX_EOK);
     NX_EXPECT_EQ(NX_SpinUnlock(&lock), NX_EOK);
@@ -64,12 +70,31 @@ NX_TEST(NX_SpinLockAndUnlock)
     }
 }
 
+NX_TEST(NX_SpinTryLock)
+{
+    NX_Spin lock;
+
+    NX_EXPECT_EQ(NX_SpinInit(&lock), NX_EOK);
+
+    NX_EXPECT_EQ(NX_SpinTryLock(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_SpinState(&lock), NX_EBUSY);
+    NX_EXPECT_NE(NX_SpinTryLock(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_SpinUnlock(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_SpinState(&lock), NX_EOK);
+
+    /* unlock a free lock keep it free */
+    NX_EXPECT_EQ(NX_SpinUnlock(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_SpinTryLock(&lock), NX_EOK);
+    NX_EXPECT_EQ(NX_SpinUnlock(&lock), NX_EOK);
+}
+
 NX_TEST_TABLE(NX_Spin)
 {
     NX_TEST_UNIT(NX_SpinInit),
     NX_TEST_UNIT(NX_SpinLock),
     NX_TEST_UNIT(NX_SpinUnlock),
     NX_TEST_UNIT(NX_SpinLockAndUnlock),
+    NX_TEST_UNIT(NX_SpinTryLock),
 };
 
 NX_TEST_CASE(NX_Spin);
@@ -50,6 +50,24 @@ NX_PRIVATE void NX_ThreadSleep1(void *arg)
     NX_ASSERT_TRUE(NX_False);
 }
 
+NX_TEST(NX_ThreadSleepNanosecond)
+{
+    NX_U64 s, e;
+
+    NX_EXPECT_EQ(NX_ThreadSleepNanosecond(0), NX_EINVAL);
+
+    /* sleep less than a tick, not rounded up to tick */
+    s = NX_HrTimerNanosecondGet();
+    NX_EXPECT_EQ(NX_ThreadSleepNanosecond(100000), NX_EOK);
+    e = NX_HrTimerNanosecondGet();
+    NX_EXPECT_GE(e - s, 100000);
+
+    s = NX_HrTimerNanosecondGet();
+    NX_EXPECT_EQ(NX_ThreadSleepNanosecond(20 * NX_NANOSECOND_PER_MILLISECOND), NX_EOK);
+    e = NX_HrTimerNanosecondGet();
+    NX_EXPECT_GE(e - s, 20 * NX_NANOSECOND_PER_MILLISECOND);
+}
+
 NX_TEST(NX_ThreadSleepIntr)
 {
     
@@ -67,10 +85,108 @@ NX_TEST(NX_ThreadSleepIntr)
 
 }
 
+NX_PRIVATE void NX_ThreadAffinity1(void *arg)
+{
+}
+
+NX_TEST(NX_ThreadSetAffinity)
+{
+    NX_Thread *thread = NX_ThreadCreate("affinity1", NX_ThreadAffinity1, NX_NULL, NX_THREAD_PRIORITY_NORMAL);
+    NX_EXPECT_NOT_NULL(thread);
+    NX_EXPECT_EQ(thread->coreAffinity, NX_CPUMASK_ALL);
+
+    NX_EXPECT_EQ(NX_ThreadSetAffinityMask(thread, NX_CPUMASK_NONE), NX_EINVAL);
+    NX_EXPECT_EQ(NX_ThreadSetAffinity(thread, NX_MULTI_CORES_NR), NX_EINVAL);
+
+    NX_EXPECT_EQ(NX_ThreadSetAffinity(thread, 0), NX_EOK);
+    NX_EXPECT_EQ(thread->coreAffinity, NX_CpuMaskCore(0));
+
+    /* cores not exist are dropped */
+    NX_EXPECT_EQ(NX_ThreadSetAffinityMask(thread, ~NX_CPUMASK_NONE), NX_EOK);
+    NX_EXPECT_EQ(thread->coreAffinity, NX_CPUMASK_ALL);
+
+    NX_EXPECT_EQ(NX_ThreadDestroy(thread), NX_EOK);
+}
+
+#ifdef CONFIG_NX_SCHED_DEADLINE
+NX_PRIVATE NX_VOLATILE int deadlineRuns = 0;
+
+NX_PRIVATE void NX_ThreadDeadline1(void *arg)
+{
+    deadlineRuns++;
+}
+
+NX_TEST(NX_ThreadSetDeadline)
+{
+    NX_Thread *thread = NX_ThreadCreate("deadline1", NX_ThreadDeadline1, NX_NULL, NX_THREAD_PRIORITY_NORMAL);
+    NX_EXPECT_NOT_NULL(thread);
+
+    /* runtime must fit in deadline, deadline in period */
+    NX_EXPECT_EQ(NX_ThreadSetDeadline(thread, 2, 1, 10), NX_EINVAL);
+    NX_EXPECT_EQ(NX_ThreadSetDeadline(thread, 1, 20, 10), NX_EINVAL);
+    NX_EXPECT_EQ(NX_ThreadSetDeadline(thread, 1, 1, 0), NX_EINVAL);
+
+    /* whole core is over admission bandwidth */
+    NX_EXPECT_EQ(NX_ThreadSetDeadline(thread, 10, 10, 10), NX_ENORES);
+
+    NX_EXPECT_EQ(NX_ThreadSetDeadline(thread, 1, 5, 10), NX_EOK);
+    NX_EXPECT_EQ(thread->priority, NX_THREAD_PRIORITY_RT_MAX);
+
+    /* back to priority class */
+    NX_EXPECT_EQ(NX_ThreadSetDeadline(thread, 0, 0, 0), NX_EOK);
+    NX_EXPECT_EQ(thread->priority, NX_THREAD_PRIORITY_NORMAL);
+
+    NX_EXPECT_EQ(NX_ThreadSetDeadline(thread, 1, 5, 10), NX_EOK);
+    NX_EXPECT_EQ(NX_ThreadStart(thread), NX_EOK);
+
+    /* deadline thread outranks us, run and exit during sleep */
+    NX_EXPECT_EQ(NX_ThreadSleep(100), NX_EOK);
+    NX_EXPECT_EQ(deadlineRuns, 1);
+}
+#endif
+
+#ifdef CONFIG_NX_SCHED_FAIR
+NX_TEST(NX_SchedFair)
+{
+    NX_SchedFairTunables old, tunables;
+
+    /* higher priority gets larger weight and slower vruntime */
+    NX_EXPECT_GT(NX_SchedFairWeight(NX_THREAD_PRIORITY_HIGH), NX_SchedFairWeight(NX_THREAD_PRIORITY_NORMAL));
+    NX_EXPECT_LT(NX_SchedFairDelta(1, NX_SchedFairWeight(NX_THREAD_PRIORITY_HIGH)),
+        NX_SchedFairDelta(1, NX_SchedFairWeight(NX_THREAD_PRIORITY_LOW)));
+
+    NX_SchedFairGetTunables(&old);
+
+    tunables.latency = 10;
+    tunables.minGranularity = 2;
+    tunables.wakeupGranularity = 1;
+    NX_EXPECT_EQ(NX_SchedFairSetTunables(&tunables), NX_EOK);
+
+    /* alone on core take whole latency, crowded core take min granularity */
+    NX_EXPECT_EQ(NX_SchedFairSlice(NX_SCHED_FAIR_WEIGHT_NORMAL, 0), 10);
+    NX_EXPECT_EQ(NX_SchedFairSlice(NX_SCHED_FAIR_WEIGHT_NORMAL, NX_SCHED_FAIR_WEIGHT_NORMAL * 9), 2);
+
+    tunables.minGranularity = 0;
+    NX_EXPECT_EQ(NX_SchedFairSetTunables(&tunables), NX_EINVAL);
+    tunables.minGranularity = 20;
+    NX_EXPECT_EQ(NX_SchedFairSetTunables(&tunables), NX_EINVAL);
+
+    NX_EXPECT_EQ(NX_SchedFairSetTunables(&old), NX_EOK);
+}
+#endif
+
 NX_TEST_TABLE(NX_Thread)
 {
     NX_TEST_UNIT(NX_ThreadSleep),
+    NX_TEST_UNIT(NX_ThreadSleepNanosecond),
     NX_TEST_UNIT(NX_ThreadSleepIntr),
+    NX_TEST_UNIT(NX_ThreadSetAffinity),
+#ifdef CONFIG_NX_SCHED_DEADLINE
+    NX_TEST_UNIT(NX_ThreadSetDeadline),
+#endif
+#ifdef CONFIG_NX_SCHED_FAIR
+    NX_TEST_UNIT(NX_SchedFair),
+#endif
 };
 
 NX_TEST_CASE(NX_Thread);
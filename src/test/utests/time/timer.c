@@ -12,6 +12,8 @@
 #include <test/utest.h>
 
 #include <base/timer.h>
+#include <base/smp.h>
+#include <base/irq.h>
 
 #ifdef CONFIG_NX_UTEST_MODS_TIMER
 
@@ -113,11 +115,63 @@ NX_TEST(TimerStop)
     NX_ClockTickDelayMillisecond(200);
 }
 
+NX_PRIVATE int cascadeTimerOccurTimes = 0;
+NX_PRIVATE NX_Bool NX_TimerCascadeHandler(NX_Timer *timer, void *arg)
+{
+    cascadeTimerOccurTimes++;
+    return NX_True;
+}
+
+NX_TEST(TimerCascade)
+{
+    cascadeTimerOccurTimes = 0;
+    /* timeout over first wheel level, cascade down before occur */
+    NX_Timer *timer0 = NX_TimerCreate(3000, NX_TimerCascadeHandler, NX_NULL, NX_TIMER_ONESHOT);
+    NX_EXPECT_NOT_NULL(timer0);
+    NX_Timer *timer1 = NX_TimerCreate(500, NX_TimerCascadeHandler, NX_NULL, NX_TIMER_ONESHOT);
+    NX_EXPECT_NOT_NULL(timer1);
+    NX_EXPECT_EQ(NX_TimerStart(timer0), NX_EOK);
+    NX_EXPECT_EQ(NX_TimerStart(timer1), NX_EOK);
+    /* waiting timer can't start again */
+    NX_EXPECT_EQ(NX_TimerStart(timer0), NX_EAGAIN);
+    NX_ClockTickDelayMillisecond(1000);
+    NX_EXPECT_EQ(cascadeTimerOccurTimes, 1);
+    NX_ClockTickDelayMillisecond(2200);
+    NX_EXPECT_EQ(cascadeTimerOccurTimes, 2);
+}
+
+NX_PRIVATE NX_VOLATILE NX_UArch localTimerCore = NX_MULTI_CORES_NR;
+NX_PRIVATE NX_Bool NX_TimerLocalHandler(NX_Timer *timer, void *arg)
+{
+    localTimerCore = NX_SMP_GetIdx();
+    return NX_True;
+}
+
+NX_TEST(TimerLocalCore)
+{
+    NX_UArch coreId;
+    NX_UArch level;
+
+    NX_Timer *timer = NX_TimerCreate(100, NX_TimerLocalHandler, NX_NULL, NX_TIMER_ONESHOT);
+    NX_EXPECT_NOT_NULL(timer);
+
+    /* thread may migrate later, timer expires on the core it armed on */
+    level = NX_IRQ_SaveLevel();
+    coreId = NX_SMP_GetIdx();
+    NX_EXPECT_EQ(NX_TimerStart(timer), NX_EOK);
+    NX_IRQ_RestoreLevel(level);
+
+    NX_ClockTickDelayMillisecond(200);
+    NX_EXPECT_EQ(localTimerCore, coreId);
+}
+
 NX_TEST_TABLE(NX_Timer)
 {
     NX_TEST_UNIT(TimerCreateAndDestroy),
     NX_TEST_UNIT(TimerStart),
     NX_TEST_UNIT(TimerStop),
+    NX_TEST_UNIT(TimerCascade),
+    NX_TEST_UNIT(TimerLocalCore),
 };
 
 NX_TEST_CASE(NX_Timer);
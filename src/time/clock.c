@@ -21,11 +21,18 @@
 
 #include <base/delay_irq.h>
 #include <base/time.h>
+#include <base/spin.h>
+#include <base/irq.h>
+#include <base/hrtimer.h>
 
 #define NX_LOG_NAME "Clock"
 #include <base/log.h>
 
 NX_IMPORT NX_Error NX_HalInitClock(void);
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+NX_IMPORT void NX_HalClockSetEvent(NX_ClockTick ticks);
+NX_IMPORT NX_U64 NX_HalClockNanosecond(void);
+#endif
 
 /* NOTE: must add NX_VOLATILE here, avoid compiler optimization  */
 NX_PRIVATE NX_VOLATILE NX_ClockTick systemClockTicks = 0;
@@ -33,8 +40,58 @@ NX_PRIVATE NX_VOLATILE NX_ClockTick systemClockTicks = 0;
 NX_PRIVATE NX_IRQ_DelayWork timerWork;
 NX_PRIVATE NX_IRQ_DelayWork schedWork;
 
+/* ticks not handled by timer work and sched work yet */
+NX_PRIVATE NX_ClockTick timerPendingTicks[NX_MULTI_CORES_NR];
+NX_PRIVATE NX_ClockTick schedPendingTicks[NX_MULTI_CORES_NR];
+
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+#define NANOSECOND_PER_TICK (NX_NANOSECOND_PER_SECOND / NX_TICKS_PER_SECOND)
+
+/**
+ * boot core may sleep up to max ticks without clock event in tickless mode,
+ * so system clock catches up from clock counter by any core reading it.
+ */
+NX_PRIVATE NX_SPIN_DEFINE_UNLOCKED(tickLock);
+NX_PRIVATE NX_U64 tickNanosecond = 0; /* clock counter of last tick counted */
+NX_PRIVATE NX_Bool tickCounterReady = NX_False;
+
+NX_PRIVATE void ClockTickCatchUp(void)
+{
+    NX_UArch level;
+    NX_U64 now;
+    NX_ClockTick second;
+
+    level = NX_IRQ_SaveLevel();
+    /* core holding lock is catching up, read the clock it updating */
+    if (tickCounterReady == NX_False || NX_SpinTryLock(&tickLock) != NX_EOK)
+    {
+        NX_IRQ_RestoreLevel(level);
+        return;
+    }
+
+    now = NX_HalClockNanosecond();
+    second = systemClockTicks / NX_TICKS_PER_SECOND;
+    /* no 64 bit division on 32 bit arch, count ticks passed one by one */
+    while (now - tickNanosecond >= NANOSECOND_PER_TICK)
+    {
+        tickNanosecond += NANOSECOND_PER_TICK;
+        systemClockTicks++;
+    }
+    for (; second < systemClockTicks / NX_TICKS_PER_SECOND; second++)
+    {
+        NX_TimeGo();
+    }
+
+    NX_SpinUnlock(&tickLock);
+    NX_IRQ_RestoreLevel(level);
+}
+#endif
+
 NX_ClockTick NX_ClockTickGet(void)
 {
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+    ClockTickCatchUp();
+#endif
     return systemClockTicks;
 }
 
@@ -45,22 +102,109 @@ void NX_ClockTickSet(NX_ClockTick tick)
 
 void NX_ClockTickGo(void)
 {
-    /* only boot core change system clock and timer */
+    NX_ClockTickAdvance(1);
+}
+
+/**
+ * advance clock with ticks passed since last clock event,
+ * one clock event may cover many ticks in tickless mode.
+ * called in interrupt with interrupt disabled.
+ */
+void NX_ClockTickAdvance(NX_ClockTick ticks)
+{
+#ifndef CONFIG_NX_CLOCK_TICKLESS
+    NX_ClockTick second;
+#endif
+
+    if (!ticks)
+    {
+        return;
+    }
+
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+    ClockTickCatchUp();
+#else
+    /* only boot core change system clock */
     if (NX_SMP_GetBootCore() == NX_SMP_GetIdx())
     {
-        systemClockTicks++;
-        if (systemClockTicks % NX_TICKS_PER_SECOND == 0)
+        second = systemClockTicks / NX_TICKS_PER_SECOND;
+        systemClockTicks += ticks;
+        for (; second < systemClockTicks / NX_TICKS_PER_SECOND; second++)
         {
             NX_TimeGo();
         }
-
-        NX_IRQ_DelayWorkHandle(&timerWork);
     }
+#endif
+
+    /* each core runs timers armed on it */
+    timerPendingTicks[NX_SMP_GetIdx()] += ticks;
+    NX_IRQ_DelayWorkHandle(&timerWork);
 #ifdef CONFIG_NX_ENABLE_SCHED
+    schedPendingTicks[NX_SMP_GetIdx()] += ticks;
     NX_IRQ_DelayWorkHandle(&schedWork);
 #endif
 }
 
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+/**
+ * ticks from now to the next clock event this core needs:
+ * the earliest of next timer timeout on it and running thread timeslice expiry.
+ */
+NX_ClockTick NX_ClockNextEventTicks(void)
+{
+    NX_UArch coreId = NX_SMP_GetIdx();
+    NX_Thread *thread = NX_ThreadSelf();
+    NX_ClockTick ticks = NX_CLOCK_TICKLESS_MAX_TICKS;
+    NX_ClockTick pending = schedPendingTicks[coreId];
+    NX_ClockTick timeout;
+
+    /* idle thread has no timeslice to expire */
+    if (thread != NX_NULL && thread != NX_SMP_GetIdle(coreId))
+    {
+        timeout = thread->ticks > pending ? thread->ticks - pending : 1;
+        if (timeout < ticks)
+        {
+            ticks = timeout;
+        }
+    }
+
+    timeout = NX_TimerNextTimeoutTicks();
+    pending = timerPendingTicks[coreId];
+    timeout = timeout > pending ? timeout - pending : 1;
+    if (timeout < ticks)
+    {
+        ticks = timeout;
+    }
+
+    return ticks ? ticks : 1;
+}
+
+/**
+ * program next clock event on current core
+ */
+void NX_ClockEventUpdate(void)
+{
+    NX_UArch level = NX_IRQ_SaveLevel();
+    NX_HalClockSetEvent(NX_ClockNextEventTicks());
+    NX_IRQ_RestoreLevel(level);
+}
+
+/**
+ * next timer on `coreId` changed, the core need reprogram clock event
+ */
+void NX_ClockEventNotify(NX_UArch coreId)
+{
+    if (coreId == NX_SMP_GetIdx())
+    {
+        NX_ClockEventUpdate();
+    }
+    else
+    {
+        NX_SMP_SendIpi(coreId, NX_SMP_IPI_CLOCK);
+    }
+}
+#endif /* CONFIG_NX_CLOCK_TICKLESS */
+
 NX_Error NX_ClockTickDelay(NX_ClockTick ticks)
 {
     NX_ClockTick start = NX_ClockTickGet();
@@ -82,25 +226,57 @@ NX_Error NX_ClockTickDelay(NX_ClockTick ticks)
 
 NX_PRIVATE void NX_TimerIrqHandler(void *arg)
 {
-    NX_TimerGo();
+    NX_UArch coreId = NX_SMP_GetIdx();
+    NX_UArch level = NX_IRQ_SaveLevel();
+    NX_ClockTick ticks = timerPendingTicks[coreId];
+    timerPendingTicks[coreId] = 0;
+    NX_IRQ_RestoreLevel(level);
+
+    NX_TimerGo(ticks);
 }
 
 NX_PRIVATE void NX_SchedIrqHandler(void *arg)
 {
     NX_Thread *thread = NX_ThreadSelf();
+    NX_UArch coreId = NX_SMP_GetIdx();
+    NX_ClockTick ticks;
+    NX_UArch level;
+
     if (thread->isTerminated != 0) /* check exit */
     {
         NX_ThreadExit(1);
     }
 
-    thread->ticks--;
-    thread->elapsedTicks++;
-    if (thread->ticks == 0)
+    level = NX_IRQ_SaveLevel();
+    ticks = schedPendingTicks[coreId];
+    schedPendingTicks[coreId] = 0;
+    NX_IRQ_RestoreLevel(level);
+
+    thread->ticks = thread->ticks > ticks ? thread->ticks - ticks : 0;
+    thread->elapsedTicks += ticks;
+
+    NX_SMP_UpdateLoad(coreId, ticks);
+
+    if (NX_ThreadIsFair(thread))
+    {
+        NX_SchedFairTick(thread, ticks);
+    }
+
+    /* tick arrived while core halted in idle */
+    if (NX_CpuGetPtr()->halted == NX_True)
+    {
+        NX_CpuGetPtr()->idleTicks += ticks;
+    }
+    if (NX_ThreadIsDeadline(thread))
+    {
+        /* deadline thread runs until budget used up, not timeslice */
+        NX_SchedDeadlineTick(thread, ticks);
+    }
+    else if (thread->ticks == 0)
     {
         // NX_LOG_I("thread:%s need sched", thread->name);
         thread->needSched = 1; /* mark sched */
     }
-    NX_ASSERT(thread->ticks >= 0);
 }
 
 NX_Error NX_ClockInit(void)
@@ -136,6 +312,12 @@ NX_Error NX_ClockInit(void)
         goto End;
     }
 
+#ifdef CONFIG_NX_CLOCK_TICKLESS
+    /* count ticks from clock counter since now */
+    tickNanosecond = NX_HalClockNanosecond();
+    tickCounterReady = NX_True;
+#endif
+
 End:
     return err;
 }
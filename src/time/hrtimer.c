@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2018-2022, NXOS Development Team
+ * SPDX-License-Identifier: Apache-2.0
+ * 
+ * Contains: high resolution one shot timer
+ * 
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-17     agent             Init
+ */
+
+#include <base/hrtimer.h>
+#include <base/spin.h>
+#include <base/smp.h>
+
+/* absolute nanoseconds from clock counter */
+NX_IMPORT NX_U64 NX_HalClockNanosecond(void);
+/* program clock comparator of current core to absolute nanoseconds, NX_HRTIMER_NEVER for none */
+NX_IMPORT void NX_HalClockSetOneshot(NX_U64 nanoseconds);
+
+/* hrtimer core while moving to other base, lockers wait it settled */
+#define HRTIMER_CORE_MIGRATING NX_MULTI_CORES_NR
+
+/**
+ * each core queues hrtimers armed on it in a pairing heap ordered by expires,
+ * the earliest one is at root and programmed to the clock comparator of the core.
+ */
+typedef struct NX_HrTimerBase
+{
+    NX_HrTimer *root;
+    NX_Spin lock;
+} NX_HrTimerBase;
+
+NX_PRIVATE NX_HrTimerBase hrtimerBases[NX_MULTI_CORES_NR];
+
+NX_Error NX_HrTimerInit(NX_HrTimer *hrtimer, void (*handler)(struct NX_HrTimer *, void *arg), void *arg)
+{
+    if (hrtimer == NX_NULL || handler == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+
+    hrtimer->child = NX_NULL;
+    hrtimer->next = NX_NULL;
+    hrtimer->prev = NX_NULL;
+    hrtimer->expires = 0;
+    hrtimer->state = NX_HRTIMER_INACTIVE;
+    hrtimer->core = NX_SMP_GetBootCore();
+    hrtimer->handler = handler;
+    hrtimer->arg = arg;
+    return NX_EOK;
+}
+
+/**
+ * lock the base hrtimer belongs to, hrtimer may move to other base before locked
+ */
+NX_PRIVATE NX_HrTimerBase *HrTimerLockBase(NX_HrTimer *hrtimer, NX_UArch *level)
+{
+    NX_HrTimerBase *base;
+    NX_UArch coreId;
+
+    while (1)
+    {
+        coreId = hrtimer->core;
+        if (coreId != HRTIMER_CORE_MIGRATING)
+        {
+            base = &hrtimerBases[coreId];
+            NX_SpinLockIRQ(&base->lock, level);
+            if (hrtimer->core == coreId)
+            {
+                return base;
+            }
+            NX_SpinUnlockIRQ(&base->lock, *level);
+        }
+    }
+}
+
+/**
+ * meld two heaps, the later root becomes first child of the earlier one
+ */
+NX_PRIVATE NX_HrTimer *HrTimerMeld(NX_HrTimer *a, NX_HrTimer *b)
+{
+    NX_HrTimer *tmp;
+
+    if (a == NX_NULL)
+    {
+        return b;
+    }
+    if (b == NX_NULL)
+    {
+        return a;
+    }
+    if (b->expires < a->expires)
+    {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    b->prev = a;
+    b->next = a->child;
+    if (a->child != NX_NULL)
+    {
+        a->child->prev = b;
+    }
+    a->child = b;
+    return a;
+}
+
+/**
+ * meld sibling list into one heap: meld pairs from left, then meld the pairs from right
+ */
+NX_PRIVATE NX_HrTimer *HrTimerMergePairs(NX_HrTimer *first)
+{
+    NX_HrTimer *pairs = NX_NULL;
+    NX_HrTimer *heap = NX_NULL;
+    NX_HrTimer *a;
+    NX_HrTimer *b;
+
+    while (first != NX_NULL)
+    {
+        a = first;
+        b = a->next;
+        first = (b != NX_NULL) ? b->next : NX_NULL;
+
+        a->next = a->prev = NX_NULL;
+        if (b != NX_NULL)
+        {
+            b->next = b->prev = NX_NULL;
+        }
+
+        /* push melded pair, list in reverse order */
+        a = HrTimerMeld(a, b);
+        a->next = pairs;
+        pairs = a;
+    }
+
+    while (pairs != NX_NULL)
+    {
+        a = pairs;
+        pairs = a->next;
+        a->next = NX_NULL;
+        heap = HrTimerMeld(heap, a);
+    }
+    return heap;
+}
+
+/**
+ * take hrtimer out of heap, must hold base lock
+ */
+NX_PRIVATE void HrTimerDel(NX_HrTimerBase *base, NX_HrTimer *hrtimer)
+{
+    if (hrtimer == base->root)
+    {
+        base->root = HrTimerMergePairs(hrtimer->child);
+    }
+    else
+    {
+        /* cut subtree from its siblings, then meld it back without its root */
+        if (hrtimer->prev->child == hrtimer)
+        {
+            hrtimer->prev->child = hrtimer->next;
+        }
+        else
+        {
+            hrtimer->prev->next = hrtimer->next;
+        }
+        if (hrtimer->next != NX_NULL)
+        {
+            hrtimer->next->prev = hrtimer->prev;
+        }
+        base->root = HrTimerMeld(base->root, HrTimerMergePairs(hrtimer->child));
+    }
+
+    hrtimer->child = NX_NULL;
+    hrtimer->next = NX_NULL;
+    hrtimer->prev = NX_NULL;
+}
+
+/**
+ * start hrtimer expires `nanoseconds` later on current core
+ */
+NX_Error NX_HrTimerStart(NX_HrTimer *hrtimer, NX_U64 nanoseconds)
+{
+    NX_HrTimerBase *base;
+    NX_UArch coreId;
+    NX_UArch level;
+    NX_U64 now;
+
+    if (hrtimer == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+
+    base = HrTimerLockBase(hrtimer, &level);
+
+    if (hrtimer->state == NX_HRTIMER_ENQUEUED)
+    {
+        NX_SpinUnlockIRQ(&base->lock, level);
+        return NX_EAGAIN;
+    }
+
+    /* hrtimer is out of heap, move it to the base of current core */
+    coreId = NX_SMP_GetIdx();
+    if (base != &hrtimerBases[coreId])
+    {
+        hrtimer->core = HRTIMER_CORE_MIGRATING;
+        NX_SpinUnlock(&base->lock);
+        base = &hrtimerBases[coreId];
+        NX_SpinLock(&base->lock);
+        hrtimer->core = coreId;
+    }
+
+    now = NX_HalClockNanosecond();
+    if (nanoseconds >= NX_HRTIMER_NEVER - now)
+    {
+        nanoseconds = NX_HRTIMER_NEVER - now - 1;
+    }
+    hrtimer->expires = now + nanoseconds;
+    hrtimer->state = NX_HRTIMER_ENQUEUED;
+
+    base->root = HrTimerMeld(base->root, hrtimer);
+
+    /* new earliest one, program clock comparator */
+    if (base->root == hrtimer)
+    {
+        NX_HalClockSetOneshot(hrtimer->expires);
+    }
+
+    NX_SpinUnlockIRQ(&base->lock, level);
+    return NX_EOK;
+}
+
+/**
+ * cancel hrtimer not expired yet, the comparator programmed for it fires with nothing to do.
+ */
+NX_Error NX_HrTimerCancel(NX_HrTimer *hrtimer)
+{
+    NX_HrTimerBase *base;
+    NX_UArch level;
+    NX_Error err = NX_EAGAIN;
+
+    if (hrtimer == NX_NULL)
+    {
+        return NX_EINVAL;
+    }
+
+    base = HrTimerLockBase(hrtimer, &level);
+    if (hrtimer->state == NX_HRTIMER_ENQUEUED)
+    {
+        HrTimerDel(base, hrtimer);
+        hrtimer->state = NX_HRTIMER_INACTIVE;
+        err = NX_EOK;
+    }
+    NX_SpinUnlockIRQ(&base->lock, level);
+    return err;
+}
+
+NX_U64 NX_HrTimerNanosecondGet(void)
+{
+    return NX_HalClockNanosecond();
+}
+
+/**
+ * run hrtimers expired on current core, called by clock interrupt when comparator fired.
+ * handler runs in base lock with interrupt disabled, must not start or cancel hrtimers.
+ */
+void NX_HrTimerRun(void)
+{
+    NX_HrTimerBase *base = &hrtimerBases[NX_SMP_GetIdx()];
+    NX_HrTimer *hrtimer;
+    NX_UArch level;
+    NX_U64 now;
+
+    NX_SpinLockIRQ(&base->lock, &level);
+
+    now = NX_HalClockNanosecond();
+    while ((hrtimer = base->root) != NX_NULL && hrtimer->expires <= now)
+    {
+        HrTimerDel(base, hrtimer);
+        hrtimer->state = NX_HRTIMER_INACTIVE;
+        hrtimer->handler(hrtimer, hrtimer->arg);
+    }
+
+    NX_HalClockSetOneshot(base->root != NX_NULL ? base->root->expires : NX_HRTIMER_NEVER);
+
+    NX_SpinUnlockIRQ(&base->lock, level);
+}
+
+void NX_HrTimersInit(void)
+{
+    NX_UArch coreId;
+
+    for (coreId = 0; coreId < NX_MULTI_CORES_NR; coreId++)
+    {
+        hrtimerBases[coreId].root = NX_NULL;
+        NX_SpinInit(&hrtimerBases[coreId].lock);
+    }
+}
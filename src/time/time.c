@@ -15,8 +15,11 @@
 
 #include <base/driver.h>
 #include <base/initcall.h>
+#include <base/seqlock.h>
 
 NX_PRIVATE NX_TIME_DEFINE(systemTime);
+/* time read often but only change once a second */
+NX_PRIVATE NX_SEQLOCK_DEFINE(systemTimeLock);
 
 NX_PRIVATE const char monthDayTable[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
@@ -104,6 +107,9 @@ NX_PRIVATE int MakeYearDays()
 
 void NX_TimeGo(void)
 {
+    NX_UArch level;
+
+    NX_SeqWriteLock(&systemTimeLock, &level);
     systemTime.second++;
     if(systemTime.second > 59)
     {
@@ -136,6 +142,7 @@ void NX_TimeGo(void)
             }
         }
     }
+    NX_SeqWriteUnlock(&systemTimeLock, level);
 }
 
 void NX_TimePrint(void)
@@ -149,20 +156,26 @@ void NX_TimePrint(void)
         "Friday",
         "Saturday"
     };
-    
+    NX_Time time;
+
+    NX_TimeGet(&time);
     NX_LOG_I("time:%d:%d:%d date:%d/%d/%d",
-        systemTime.hour, systemTime.minute, systemTime.second,
-        systemTime.year, systemTime.month, systemTime.day);
-    NX_LOG_I("week day:%d %s year day:%d", systemTime.weekDay, weekDay[systemTime.weekDay], systemTime.yearDay);
+        time.hour, time.minute, time.second,
+        time.year, time.month, time.day);
+    NX_LOG_I("week day:%d %s year day:%d", time.weekDay, weekDay[time.weekDay], time.yearDay);
 }
 
 NX_Error NX_TimeSet(NX_Time * time)
 {
+    NX_UArch level;
+
     if (!time)
     {
         return NX_EINVAL;
     }
 
+    NX_SeqWriteLock(&systemTimeLock, &level);
+
     systemTime.day = time->day;
     systemTime.hour = time->hour;
     systemTime.minute = time->minute;
@@ -172,25 +185,32 @@ NX_Error NX_TimeSet(NX_Time * time)
 
     systemTime.weekDay = MakeWeekDay(time->year, time->month, time->day);
     systemTime.yearDay = MakeYearDays();
+    NX_SeqWriteUnlock(&systemTimeLock, level);
 
     return NX_EOK;
 }
 
 NX_Error NX_TimeGet(NX_Time * time)
 {
+    NX_UArch sequence;
+
     if (!time)
     {
         return NX_EINVAL;
     }
     
-    time->day = systemTime.day;
-    time->hour = systemTime.hour;
-    time->minute = systemTime.minute;
-    time->month = systemTime.month;
-    time->second = systemTime.second;
-    time->weekDay = systemTime.weekDay;
-    time->year = systemTime.year;
-    time->yearDay = systemTime.yearDay;
+    do
+    {
+        sequence = NX_SeqReadBegin(&systemTimeLock);
+        time->day = systemTime.day;
+        time->hour = systemTime.hour;
+        time->minute = systemTime.minute;
+        time->month = systemTime.month;
+        time->second = systemTime.second;
+        time->weekDay = systemTime.weekDay;
+        time->year = systemTime.year;
+        time->yearDay = systemTime.yearDay;
+    } while (NX_SeqReadRetry(&systemTimeLock, sequence) == NX_True);
 
     return NX_EOK;
 }
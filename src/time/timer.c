@@ -15,21 +15,54 @@
 #include <base/log.h>
 #include <base/debug.h>
 #include <base/spin.h>
+#include <base/smp.h>
 
-#define NX_IDLE_TIMER_TIMEOUT  NX_MAX_TIMER_TIMEOUT
-#define NX_IDLE_TIMER_TIMEOUT_TICKS  (NX_IDLE_TIMER_TIMEOUT / (1000 / NX_TICKS_PER_SECOND))
+#define NX_MAX_TIMER_TIMEOUT_TICKS  (NX_MAX_TIMER_TIMEOUT / (1000 / NX_TICKS_PER_SECOND))
 
-NX_PRIVATE NX_LIST_HEAD(timerListHead);
+/**
+ * hierarchical timing wheel: level 0 has one bucket per tick, a bucket of upper level
+ * covers one round of the level below, its timers cascade down when the level below
+ * wraps to it. so timer start and stop are O(1), and a tick only runs its own bucket.
+ */
+#define TIMER_WHEEL_LEVELS  5
+#define TIMER_ROOT_BITS     8
+#define TIMER_LEVEL_BITS    6
+#define TIMER_ROOT_SIZE     (1UL << TIMER_ROOT_BITS)
+#define TIMER_LEVEL_SIZE    (1UL << TIMER_LEVEL_BITS)
+
+/* log2 of ticks a bucket on level covers */
+#define TIMER_LEVEL_SHIFT(level) ((level) ? TIMER_ROOT_BITS + ((level) - 1) * TIMER_LEVEL_BITS : 0)
+#define TIMER_LEVEL_MASK(level) ((level) ? TIMER_LEVEL_SIZE - 1 : TIMER_ROOT_SIZE - 1)
+
+/* ticks wrap, compare them by distance */
+#define TIMER_TICK_DIFF(a, b) ((NX_IArch)((a) - (b)))
+
+/* timer core while moving to other base, lockers wait it settled */
+#define TIMER_CORE_MIGRATING NX_MULTI_CORES_NR
+
+/**
+ * each core has its own timing wheel, timer is armed on the core started it
+ * and expires on that core's tick, so timers on different cores never contend.
+ */
+typedef struct NX_TimerBase
+{
+    NX_List wheelRoot[TIMER_ROOT_SIZE];
+    NX_List wheelUpper[TIMER_WHEEL_LEVELS - 1][TIMER_LEVEL_SIZE];
+    NX_UArch wheelCount[TIMER_WHEEL_LEVELS];  /* timers on each level */
 
-/* timer tick is different with clock tick */
-NX_PRIVATE NX_VOLATILE NX_ClockTick timerTicks = 0;
+    /* next tick wheel runs, ticks before it are all done */
+    NX_ClockTick wheelTicks;
 
-/* next timeout tick */
-NX_PRIVATE NX_VOLATILE NX_ClockTick nextTimeoutTicks = 0;
+    /* timer tick is different with clock tick, only changed by its core */
+    NX_VOLATILE NX_ClockTick timerTicks;
 
-NX_PRIVATE NX_Timer idleTimer;
+    /* next timeout tick */
+    NX_VOLATILE NX_ClockTick nextTimeoutTicks;
 
-NX_PRIVATE NX_Spin timersLock;
+    NX_Spin lock;
+} NX_TimerBase;
+
+NX_PRIVATE NX_TimerBase timerBases[NX_MULTI_CORES_NR];
 
 NX_Error NX_TimerInit(NX_Timer *timer, NX_UArch milliseconds, 
                           NX_Bool (*handler)(struct NX_Timer *, void *arg), void *arg, 
@@ -51,6 +84,8 @@ NX_Error NX_TimerInit(NX_Timer *timer, NX_UArch milliseconds,
     timer->timeTicks = NX_MILLISECOND_TO_TICKS(milliseconds);
     
     timer->timeout = 0;
+    timer->level = 0;
+    timer->core = NX_SMP_GetBootCore();
     
     timer->handler = handler;
     timer->arg = arg;
@@ -76,23 +111,127 @@ NX_Timer *NX_TimerCreate(NX_UArch milliseconds,
     return timer;
 }
 
-NX_PRIVATE void NX_TimerRemove(NX_Timer *timer, NX_Bool onTimerList, NX_Bool destroy)
+/**
+ * lock the base timer belongs to, timer may move to other base before locked
+ */
+NX_PRIVATE NX_TimerBase *TimerLockBase(NX_Timer *timer, NX_UArch *level)
 {
-    if (onTimerList == NX_True)
+    NX_TimerBase *base;
+    NX_UArch coreId;
+
+    while (1)
     {
-        /* del from list */
-        NX_ListDel(&timer->list);
+        coreId = timer->core;
+        if (coreId != TIMER_CORE_MIGRATING)
+        {
+            base = &timerBases[coreId];
+            NX_SpinLockIRQ(&base->lock, level);
+            if (timer->core == coreId)
+            {
+                return base;
+            }
+            NX_SpinUnlockIRQ(&base->lock, *level);
+        }
+    }
+}
+
+NX_PRIVATE NX_List *TimerWheelBucket(NX_TimerBase *base, int level, NX_ClockTick tick)
+{
+    NX_UArch index = (tick >> TIMER_LEVEL_SHIFT(level)) & TIMER_LEVEL_MASK(level);
+    return level ? &base->wheelUpper[level - 1][index] : &base->wheelRoot[index];
+}
 
-        /* update next time */
-        NX_Timer *next;
-        NX_ListForEachEntry(next, &timerListHead, list)
+/**
+ * put timer in bucket by ticks left from wheel ticks, must hold base lock
+ */
+NX_PRIVATE void TimerWheelAdd(NX_TimerBase *base, NX_Timer *timer)
+{
+    NX_ClockTick timeout = timer->timeout;
+    NX_ClockTick delta;
+    int level;
+
+    /* timeout already, run on next wheel tick */
+    if (TIMER_TICK_DIFF(timeout, base->wheelTicks) < 0)
+    {
+        timeout = base->wheelTicks;
+    }
+    delta = timeout - base->wheelTicks;
+
+    /* lowest level whose round covers delta, top level covers the rest */
+    for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++)
+    {
+        if ((delta >> TIMER_LEVEL_SHIFT(level + 1)) == 0)
         {
-            if (next->timeout > timerTicks)
+            break;
+        }
+    }
+
+    timer->level = level;
+    base->wheelCount[level]++;
+    NX_ListAddTail(&timer->list, TimerWheelBucket(base, level, timeout));
+}
+
+NX_PRIVATE void TimerWheelDel(NX_TimerBase *base, NX_Timer *timer)
+{
+    NX_ListDel(&timer->list);
+    base->wheelCount[timer->level]--;
+}
+
+NX_PRIVATE NX_Bool TimerWheelEmpty(NX_TimerBase *base)
+{
+    int level;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (base->wheelCount[level])
+        {
+            return NX_False;
+        }
+    }
+    return NX_True;
+}
+
+/**
+ * first tick wheel has work from wheel ticks: timeout on level 0, or cascade of
+ * the lowest upper level has timers. must hold base lock.
+ */
+NX_PRIVATE NX_ClockTick TimerWheelNextTick(NX_TimerBase *base)
+{
+    NX_ClockTick wheelTicks = base->wheelTicks;
+    NX_ClockTick tick = wheelTicks + NX_MAX_TIMER_TIMEOUT_TICKS;
+    NX_ClockTick mask;
+    NX_UArch i;
+    int level;
+
+    for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (base->wheelCount[level])
+        {
+            mask = (1UL << TIMER_LEVEL_SHIFT(level)) - 1;
+            tick = (wheelTicks + mask) & ~mask;
+            break;
+        }
+    }
+
+    if (base->wheelCount[0])
+    {
+        for (i = 0; i < TIMER_ROOT_SIZE && TIMER_TICK_DIFF(wheelTicks + i, tick) < 0; i++)
+        {
+            if (!NX_ListEmpty(&base->wheelRoot[(wheelTicks + i) & TIMER_LEVEL_MASK(0)]))
             {
+                tick = wheelTicks + i;
                 break;
             }
         }
-        nextTimeoutTicks = next->timeout;
+    }
+    return tick;
+}
+
+NX_PRIVATE void NX_TimerRemove(NX_TimerBase *base, NX_Timer *timer, NX_Bool onTimerList, NX_Bool destroy)
+{
+    if (onTimerList == NX_True)
+    {
+        TimerWheelDel(base, timer);
     }
     if (destroy == NX_True)
     {
@@ -122,9 +261,9 @@ NX_Error NX_TimerDestroy(NX_Timer *timer)
     case NX_TIMER_INITED:
         {
             NX_UArch level;
-            NX_SpinLockIRQ(&timersLock, &level);
-            NX_TimerRemove(timer, NX_False, NX_True);
-            NX_SpinUnlockIRQ(&timersLock, level);
+            NX_TimerBase *base = TimerLockBase(timer, &level);
+            NX_TimerRemove(base, timer, NX_False, NX_True);
+            NX_SpinUnlockIRQ(&base->lock, level);
         }
         break;
     default:
@@ -141,66 +280,75 @@ NX_Error NX_TimerStart(NX_Timer *timer)
     }
 
     NX_UArch level;
-
-    NX_SpinLockIRQ(&timersLock, &level);
-
-    /* calc timeout here */
-    timer->timeout = timer->timeTicks + timerTicks;
+    NX_UArch coreId;
+    NX_TimerBase *base;
+    NX_Bool headChanged = NX_False;
 
     /* timeout is invalid */
-    if (NX_IDLE_TIMER_TIMEOUT_TICKS - timer->timeTicks < timerTicks)
+    if (timer->timeTicks > NX_MAX_TIMER_TIMEOUT_TICKS)
     {
-        NX_SpinUnlockIRQ(&timersLock, level);
         return NX_EINVAL;
     }
 
-    /* make sure not on the list */
-    if (NX_ListFind(&timer->list, &timerListHead))
+    base = TimerLockBase(timer, &level);
+
+    /* make sure not on the wheel */
+    if (timer->state == NX_TIMER_WAITING || timer->state == NX_TIMER_PROCESSING)
     {
-        NX_SpinUnlockIRQ(&timersLock, level);
+        NX_SpinUnlockIRQ(&base->lock, level);
         return NX_EAGAIN;
     }
-    
+
+    /* arm on current core, core without clock running yet leaves it to boot core */
+    coreId = NX_SMP_GetIdx();
+    if (NX_CpuGetIndex(coreId)->online == NX_False)
+    {
+        coreId = NX_SMP_GetBootCore();
+    }
+
+    /* timer is off wheel, move it to the base of that core */
+    if (base != &timerBases[coreId])
+    {
+        timer->core = TIMER_CORE_MIGRATING;
+        NX_SpinUnlock(&base->lock);
+        base = &timerBases[coreId];
+        NX_SpinLock(&base->lock);
+        timer->core = coreId;
+    }
+
+    /* empty wheel may fall behind timer ticks, catch it up */
+    if (TimerWheelEmpty(base) == NX_True && TIMER_TICK_DIFF(base->timerTicks, base->wheelTicks) > 0)
+    {
+        base->wheelTicks = base->timerTicks;
+    }
+
+    /* calc timeout here */
+    timer->timeout = timer->timeTicks + base->timerTicks;
+
     /* waiting timeout state */
     timer->state = NX_TIMER_WAITING;
-    if (NX_ListEmpty(&timerListHead))
+    TimerWheelAdd(base, timer);
+
+    if (TIMER_TICK_DIFF(timer->timeout, base->nextTimeoutTicks) < 0)
     {
-        /* inseart at head */
-        NX_ListAdd(&timer->list, &timerListHead);
-        nextTimeoutTicks = timer->timeout;
+        base->nextTimeoutTicks = timer->timeout;
+        headChanged = NX_True;
     }
-    else
+
+    NX_SpinUnlockIRQ(&base->lock, level);
+
+    /* clock event may be programmed later than new timer in tickless mode */
+    if (headChanged == NX_True)
     {
-        NX_Timer *first = NX_ListFirstEntry(&timerListHead, NX_Timer, list);
-        if (timer->timeout < first->timeout)
-        {
-            /* insert at head */
-            NX_ListAdd(&timer->list, &timerListHead);
-            nextTimeoutTicks = timer->timeout;
-        }
-        else
-        {
-            /* insert after nearly timer */
-            NX_Timer *prev = NX_NULL;
-            NX_ListForEachEntryReverse(prev, &timerListHead, list)
-            {
-                if (timer->timeout >= prev->timeout)
-                {
-                    NX_ListAdd(&timer->list, &prev->list);
-                    break;
-                }
-            }
-        }
+        NX_ClockEventNotify(coreId);
     }
-
-    NX_SpinUnlockIRQ(&timersLock, level);
     return NX_EOK;
 }
 
 /**
  * only stop a timer, not destroy
  */
-NX_PRIVATE NX_Error NX_TimerStopUnlocked(NX_Timer *timer)
+NX_PRIVATE NX_Error NX_TimerStopUnlocked(NX_TimerBase *base, NX_Timer *timer)
 {
     if (timer == NX_NULL)
     {
@@ -220,7 +368,7 @@ NX_PRIVATE NX_Error NX_TimerStopUnlocked(NX_Timer *timer)
     /* direct del timer when waiting timer */
     if (state == NX_TIMER_WAITING)
     {
-        NX_TimerRemove(timer, NX_True, NX_False);
+        NX_TimerRemove(base, timer, NX_True, NX_False);
     }
 
     return NX_EOK;
@@ -238,15 +386,15 @@ NX_Error NX_TimerStop(NX_Timer *timer)
 
     NX_Error err;
     NX_UArch level;
-    NX_SpinLockIRQ(&timersLock, &level);
+    NX_TimerBase *base = TimerLockBase(timer, &level);
 
-    err = NX_TimerStopUnlocked(timer);
+    err = NX_TimerStopUnlocked(base, timer);
     
-    NX_SpinUnlockIRQ(&timersLock, level);
+    NX_SpinUnlockIRQ(&base->lock, level);
     return err;
 }
 
-NX_PRIVATE void NX_TimerInvoke(NX_Timer *timer)
+NX_PRIVATE void NX_TimerInvoke(NX_TimerBase *base, NX_Timer *timer)
 {
     timer->state = NX_TIMER_PROCESSING;
     
@@ -263,64 +411,213 @@ NX_PRIVATE void NX_TimerInvoke(NX_Timer *timer)
     /* when calling the handler, called stop timer, need stop here */
     if (timer->state == NX_TIMER_STOPPED)
     {
-        NX_TimerRemove(timer, NX_True, NX_True);
+        NX_TimerRemove(base, timer, NX_False, NX_True);
     }
     else    /* always processing */
     {
         if (timer->flags & NX_TIMER_PERIOD)
         {
             /* update timer timeout */
-            timer->timeout = timerTicks + timer->timeTicks;
+            timer->timeout = base->timerTicks + timer->timeTicks;
             timer->state = NX_TIMER_WAITING;
+            TimerWheelAdd(base, timer);
         }
         else
         {
             timer->state = NX_TIMER_STOPPED;
-            NX_TimerRemove(timer, NX_True, NX_True);
+            NX_TimerRemove(base, timer, NX_False, NX_True);
         }        
     }
-    
+
+}
+
+/**
+ * move timers in bucket of level at wheel ticks down to lower levels
+ */
+NX_PRIVATE void TimerWheelCascade(NX_TimerBase *base, int level)
+{
+    NX_List *bucket = TimerWheelBucket(base, level, base->wheelTicks);
+    NX_Timer *timer;
+    NX_Timer *next;
+
+    NX_ListForEachEntrySafe(timer, next, bucket, list)
+    {
+        TimerWheelDel(base, timer);
+        TimerWheelAdd(base, timer);
+    }
 }
 
 /**
- * only master cpu will call this
+ * cascade upper levels the lower ones wrapped to, then run timers timeout at wheel ticks.
+ * must hold base lock.
  */
-void NX_TimerGo(void)
+NX_PRIVATE void TimerWheelRunTick(NX_TimerBase *base)
 {
-    NX_Timer *timer = NX_NULL;
-    NX_Timer *next = NX_NULL;
+    NX_List *bucket;
+    NX_List expired;
+    NX_Timer *timer;
+    int level;
+
+    for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (base->wheelTicks & ((1UL << TIMER_LEVEL_SHIFT(level)) - 1))
+        {
+            break;
+        }
+        TimerWheelCascade(base, level);
+    }
+
+    bucket = TimerWheelBucket(base, 0, base->wheelTicks);
+    base->wheelTicks++;
+
+    if (NX_ListEmpty(bucket))
+    {
+        return;
+    }
+
+    /* take bucket out, period timer restarted by handler may come back to it for next round */
+    NX_ListReplaceInit(bucket, &expired);
+    while (!NX_ListEmpty(&expired))
+    {
+        timer = NX_ListFirstEntry(&expired, NX_Timer, list);
+        TimerWheelDel(base, timer);
+        NX_TimerInvoke(base, timer);
+    }
+}
+
+/**
+ * run timers timeout on current core, each core calls this on its own tick
+ */
+void NX_TimerGo(NX_ClockTick ticks)
+{
+    NX_TimerBase *base = &timerBases[NX_SMP_GetIdx()];
+    NX_ClockTick next;
     
-    timerTicks++;
+    base->timerTicks += ticks;
 
-    if (timerTicks < nextTimeoutTicks)
+    if (TIMER_TICK_DIFF(base->timerTicks, base->nextTimeoutTicks) < 0)
     {
         return;
     }
 
     NX_UArch level;
     
-    NX_SpinLockIRQ(&timersLock, &level);
+    NX_SpinLockIRQ(&base->lock, &level);
 
-    NX_ListForEachEntrySafe(timer, next, &timerListHead, list)
+    /* skip ticks wheel has nothing to do */
+    while (TIMER_TICK_DIFF(base->timerTicks, base->wheelTicks) >= 0)
     {
-        if (timer->timeout > timerTicks) /* not timeout */
+        next = TimerWheelNextTick(base);
+        if (TIMER_TICK_DIFF(next, base->timerTicks) > 0)
         {
+            base->wheelTicks = base->timerTicks + 1;
             break;
         }
-        /* timeout == timerTicks -> timeout! */
-        NX_TimerInvoke(timer);
+        base->wheelTicks = next;
+        TimerWheelRunTick(base);
     }
 
     /* find next timer */
-    NX_ListForEachEntry(timer, &timerListHead, list)
+    base->nextTimeoutTicks = TimerWheelNextTick(base);
+    NX_SpinUnlockIRQ(&base->lock, level);
+}
+
+/**
+ * move timers waiting on `fromCore` to the base of `toCore`, ticks left to timeout kept.
+ * timer being processed is off wheel, its core keeps it. called irq disabled.
+ */
+void NX_TimerMigrate(NX_UArch fromCore, NX_UArch toCore)
+{
+    NX_TimerBase *from;
+    NX_TimerBase *to;
+    NX_List *bucket;
+    NX_Timer *timer;
+    NX_Timer *next;
+    NX_ClockTick left;
+    NX_Bool headChanged = NX_False;
+    NX_UArch i;
+    int level;
+
+    if (fromCore >= NX_MULTI_CORES_NR || toCore >= NX_MULTI_CORES_NR || fromCore == toCore)
     {
-        if (timer->timeout > timerTicks)
+        return;
+    }
+    from = &timerBases[fromCore];
+    to = &timerBases[toCore];
+
+    /* lock two bases in core order */
+    NX_SpinLock(fromCore < toCore ? &from->lock : &to->lock);
+    NX_SpinLock(fromCore < toCore ? &to->lock : &from->lock);
+
+    if (TimerWheelEmpty(to) == NX_True && TIMER_TICK_DIFF(to->timerTicks, to->wheelTicks) > 0)
+    {
+        to->wheelTicks = to->timerTicks;
+    }
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for (i = 0; from->wheelCount[level] && i <= TIMER_LEVEL_MASK(level); i++)
         {
-            break;
+            bucket = level ? &from->wheelUpper[level - 1][i] : &from->wheelRoot[i];
+            NX_ListForEachEntrySafe(timer, next, bucket, list)
+            {
+                TimerWheelDel(from, timer);
+                left = TIMER_TICK_DIFF(timer->timeout, from->timerTicks) > 0 ? timer->timeout - from->timerTicks : 0;
+                timer->timeout = to->timerTicks + left;
+                timer->core = toCore;
+                TimerWheelAdd(to, timer);
+
+                if (TIMER_TICK_DIFF(timer->timeout, to->nextTimeoutTicks) < 0)
+                {
+                    to->nextTimeoutTicks = timer->timeout;
+                    headChanged = NX_True;
+                }
+            }
         }
     }
-    nextTimeoutTicks = timer->timeout;
-    NX_SpinUnlockIRQ(&timersLock, level);
+    from->nextTimeoutTicks = TimerWheelNextTick(from);
+
+    NX_SpinUnlock(&to->lock);
+    NX_SpinUnlock(&from->lock);
+
+    if (headChanged == NX_True)
+    {
+        NX_ClockEventNotify(toCore);
+    }
+}
+
+/**
+ * core going idle hands its timers to the busiest core, then it sleeps without clock event
+ * for them. timers kept when no other core busy, some core has to wake for them anyway.
+ */
+void NX_TimerIdle(void)
+{
+    NX_UArch coreId = NX_SMP_GetIdx();
+    NX_UArch busiestCore;
+
+    if (TimerWheelEmpty(&timerBases[coreId]) == NX_True)
+    {
+        return;
+    }
+
+    busiestCore = NX_SMP_FindBusiestCore(coreId);
+    if (busiestCore >= NX_MULTI_CORES_NR || NX_AtomicGet(&NX_CpuGetIndex(busiestCore)->threadCount) == 0)
+    {
+        return;
+    }
+    NX_TimerMigrate(coreId, busiestCore);
+}
+
+/**
+ * ticks from now to the next timer timeout on current core
+ */
+NX_ClockTick NX_TimerNextTimeoutTicks(void)
+{
+    NX_TimerBase *base = &timerBases[NX_SMP_GetIdx()];
+    NX_ClockTick now = base->timerTicks;
+    NX_ClockTick next = base->nextTimeoutTicks;
+
+    return TIMER_TICK_DIFF(next, now) > 0 ? next - now : 0;
 }
 
 void NX_TimerDump(NX_Timer *timer)
@@ -335,25 +632,34 @@ void NX_TimerDump(NX_Timer *timer)
     NX_LOG_I("arg:%p", timer->arg);
 }
 
-/**
- * recalc all timers timeout
- * this will called with interrupt disabled
- */
-NX_PRIVATE NX_Bool idleTimerHandler(NX_Timer *timer, void *arg)
+void NX_TimersInit(void)
 {
-    NX_ClockTick delta = idleTimer.timeout;
-    timerTicks -= delta;
-    NX_Timer *tmp;
-    NX_ListForEachEntry (tmp, &timerListHead, list)
+    NX_TimerBase *base;
+    NX_UArch coreId;
+    int i, j;
+
+    for (coreId = 0; coreId < NX_MULTI_CORES_NR; coreId++)
     {
-        tmp->timeout -= delta;
-    }
-    return NX_True;
-}
+        base = &timerBases[coreId];
+        NX_SpinInit(&base->lock);
 
-void NX_TimersInit(void)
-{
-    NX_SpinInit(&timersLock);
-    NX_ASSERT(NX_TimerInit(&idleTimer, NX_IDLE_TIMER_TIMEOUT, idleTimerHandler, NX_NULL, NX_True) == NX_EOK);
-    NX_ASSERT(NX_TimerStart(&idleTimer) == NX_EOK);
+        for (i = 0; i < TIMER_ROOT_SIZE; i++)
+        {
+            NX_ListInit(&base->wheelRoot[i]);
+        }
+        for (i = 0; i < TIMER_WHEEL_LEVELS - 1; i++)
+        {
+            for (j = 0; j < TIMER_LEVEL_SIZE; j++)
+            {
+                NX_ListInit(&base->wheelUpper[i][j]);
+            }
+        }
+        for (i = 0; i < TIMER_WHEEL_LEVELS; i++)
+        {
+            base->wheelCount[i] = 0;
+        }
+        base->wheelTicks = 0;
+        base->timerTicks = 0;
+        base->nextTimeoutTicks = NX_MAX_TIMER_TIMEOUT_TICKS;
+    }
 }